@@ -0,0 +1,135 @@
+#include "Arena.h"
+
+thread_local Arena* Arena::current = nullptr;
+std::atomic<long long> Arena::chunksAllocated(0);
+std::atomic<long long> Arena::arenaAllocations(0);
+
+Arena::Arena()
+{
+	_bytesUsed = 0;
+	_allocations = 0;
+}
+
+Arena::~Arena()
+{
+	Release();
+}
+
+void* Arena::Allocate(const size_t& bytes)
+{
+	size_t alignedBytes = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+	if (_current == nullptr or static_cast<size_t>(_end - _current) < alignedBytes)
+	{
+		//chunk header is padded to ALIGNMENT, big blocks get a chunk of their own
+		size_t chunkSize = CHUNK_SIZE;
+		if (alignedBytes > chunkSize)
+		{
+			chunkSize = alignedBytes;
+		}
+
+		Chunk* chunk = static_cast<Chunk*>(::operator new(ALIGNMENT + chunkSize));
+		chunk->next = _chunks;
+		chunk->size = chunkSize;
+		_chunks = chunk;
+		_current = reinterpret_cast<char*>(chunk) + ALIGNMENT;
+		_end = _current + chunkSize;
+		chunksAllocated++;
+	}
+
+	void* block = _current;
+	_current += alignedBytes;
+	_bytesUsed += alignedBytes;
+	_allocations++;
+	return block;
+}
+
+void Arena::Release()
+{
+	arenaAllocations += _allocations;
+
+	while (_finalizers != nullptr)
+	{
+		_finalizers->destroy(_finalizers->object);
+		_finalizers = _finalizers->next;
+	}
+
+	while (_chunks != nullptr)
+	{
+		Chunk* next = _chunks->next;
+		::operator delete(_chunks);
+		_chunks = next;
+	}
+
+	_current = nullptr;
+	_end = nullptr;
+	_bytesUsed = 0;
+	_allocations = 0;
+}
+
+size_t Arena::BytesUsed() const
+{
+	return _bytesUsed;
+}
+
+long long Arena::Allocations() const
+{
+	return _allocations;
+}
+
+void* Arena::AllocateTagged(const size_t& bytes, const MEMORY_TAG& tag)
+{
+	static_assert(sizeof(BlockHeader) <= ALIGNMENT, "block header does not fit in front of the block");
+
+	//the header before the block says whether it has to be freed - arena blocks go away with their arena
+	char* block = nullptr;
+
+	if (current != nullptr)
+	{
+		block = static_cast<char*>(current->Allocate(ALIGNMENT + bytes));
+	}
+	else
+	{
+		block = static_cast<char*>(::operator new(ALIGNMENT + bytes));
+	}
+
+	BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+	header->arena = current;
+	header->bytes = static_cast<unsigned int>(bytes);
+	header->tag = tag;
+	MemoryStats::Allocated(tag, bytes);
+	return block + ALIGNMENT;
+}
+
+void Arena::DeallocateTagged(void* pointer)
+{
+	char* block = static_cast<char*>(pointer) - ALIGNMENT;
+	BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+	MemoryStats::Freed(header->tag, header->bytes);
+
+	if (header->arena == nullptr)
+	{
+		::operator delete(block);
+	}
+}
+
+long long Arena::ChunksAllocated()
+{
+	return chunksAllocated;
+}
+
+long long Arena::ArenaAllocations()
+{
+	return arenaAllocations;
+}
+
+ArenaScope::ArenaScope(Arena* arena)
+{
+	_previous = Arena::current;
+	Arena::current = arena;
+}
+
+ArenaScope::~ArenaScope()
+{
+	Arena::current = _previous;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <atomic>
+#include <utility>
+#include <type_traits>
+#include "Exception.h"
+#include "MemoryStats.h"
+
+// bump allocator owning everything allocated for one level (or one room), released in one step
+// objects made with New are destroyed by Release in reverse order, nothing made with it may be deleted on its own
+
+class Arena
+{
+private:
+	struct Chunk
+	{
+		Chunk* next;
+		size_t size; //usable bytes after the header
+	};
+
+	struct BlockHeader //before every tagged block, padded to ALIGNMENT
+	{
+		Arena* arena; //nullptr - the block is from the heap
+		unsigned int bytes;
+		MEMORY_TAG tag;
+	};
+
+	struct Finalizer
+	{
+		void (*destroy)(void*);
+		void* object;
+		Finalizer* next;
+	};
+
+	static const size_t CHUNK_SIZE = 64 * 1024;
+	static const size_t ALIGNMENT = 16;
+
+	Chunk* _chunks = nullptr;
+	char* _current = nullptr; //free space of the newest chunk
+	char* _end = nullptr;
+	Finalizer* _finalizers = nullptr;
+	size_t _bytesUsed;
+	long long _allocations;
+
+	static thread_local Arena* current; //arena containers allocate from, nullptr - the heap
+	static std::atomic<long long> chunksAllocated;
+	static std::atomic<long long> arenaAllocations; //of released arenas
+
+	template<class T> static void Destroy(void* object)
+	{
+		static_cast<T*>(object)->~T();
+	}
+
+	friend class ArenaScope;
+
+public:
+	Arena();
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+	~Arena();
+
+	void* Allocate(const size_t& bytes); //16-byte aligned, freed only by Release
+	void Release(); //destroys objects made with New and frees every chunk
+	size_t BytesUsed() const;
+	long long Allocations() const;
+
+	template<class T, class... Arguments> T* New(Arguments&&... arguments)
+	{
+		T* object = new (Allocate(sizeof(T))) T(std::forward<Arguments>(arguments)...);
+
+		if (!std::is_trivially_destructible<T>::value)
+		{
+			Finalizer* finalizer = static_cast<Finalizer*>(Allocate(sizeof(Finalizer)));
+			finalizer->destroy = &Destroy<T>;
+			finalizer->object = object;
+			finalizer->next = _finalizers;
+			_finalizers = finalizer;
+		}
+
+		return object;
+	}
+
+	//tagged blocks for ArenaAllocator - they come from the current arena, or from the heap without one, and are counted in MemoryStats
+	static void* AllocateTagged(const size_t& bytes, const MEMORY_TAG& tag);
+	static void DeallocateTagged(void* pointer);
+
+	//process-wide counters
+	static long long ChunksAllocated();
+	static long long ArenaAllocations(); //counted when an arena is released
+};
+
+class ArenaScope //containers created while it lives allocate from the given arena (nullptr - the heap)
+{
+private:
+	Arena* _previous;
+
+public:
+	ArenaScope(Arena* arena);
+	ArenaScope(const ArenaScope&) = delete;
+	ArenaScope& operator=(const ArenaScope&) = delete;
+	~ArenaScope();
+};
+
+template<class T, MEMORY_TAG tag = MEMORY_TAG::OTHER> class ArenaAllocator //stateless, every block remembers where it came from, so containers can move between arenas and the heap
+{
+public:
+	typedef T value_type;
+
+	template<class U> struct rebind //containers allocate their nodes for the same subsystem
+	{
+		typedef ArenaAllocator<U, tag> other;
+	};
+
+	ArenaAllocator() {}
+	template<class U> ArenaAllocator(const ArenaAllocator<U, tag>&) {}
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(Arena::AllocateTagged(count * sizeof(T), tag));
+	}
+
+	void deallocate(T* pointer, size_t)
+	{
+		Arena::DeallocateTagged(pointer);
+	}
+
+	template<class U> bool operator==(const ArenaAllocator<U, tag>&) const { return true; }
+	template<class U> bool operator!=(const ArenaAllocator<U, tag>&) const { return false; }
+};
@@ -0,0 +1,578 @@
+//winsock2 has to be included before Windows.h (which the header pulls in)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include "BroadcastServer.h"
+
+BroadcastServer::BroadcastServer(const int& port, const size_t& maxQueuedBytes, const int& maxResyncs, const std::string& bindAddress)
+{
+	WSADATA data;
+	if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+	{
+		throw new Exception(1, "[BROADCAST] winsock startup error.");
+	}
+
+	_maxQueuedBytes = maxQueuedBytes;
+	_maxResyncs = maxResyncs;
+	_readBuffer = std::vector<char>(4096);
+	_keyframeWanted = false;
+	_wakePending = false;
+	_viewersNumber = 0;
+	_stopping = false;
+	_frames = 0;
+	_keyframes = 0;
+	_frameBytes = 0;
+	_bytesSent = 0;
+	_accepted = 0;
+	_resyncs = 0;
+	_dropped = 0;
+
+	//viewers are not authenticated, so only this machine can watch unless another address is asked for
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(static_cast<unsigned short>(port));
+	if (inet_pton(AF_INET, bindAddress.c_str(), &address.sin_addr) != 1)
+	{
+		WSACleanup();
+		throw new Exception(1, "[BROADCAST] invalid bind address " + bindAddress + ".");
+	}
+
+	SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listener != INVALID_SOCKET)
+	{
+		int reuse = 1;
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+	}
+
+	if (listener == INVALID_SOCKET or bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR or listen(listener, SOMAXCONN) == SOCKET_ERROR)
+	{
+		if (listener != INVALID_SOCKET)
+		{
+			closesocket(listener);
+		}
+		WSACleanup();
+		throw new Exception(1, "[BROADCAST] can not listen on " + bindAddress + ":" + std::to_string(port) + ".");
+	}
+
+	u_long nonBlocking = 1;
+	ioctlsocket(listener, FIONBIO, &nonBlocking);
+
+	socklen_t addressLength = sizeof(address);
+	getsockname(listener, reinterpret_cast<sockaddr*>(&address), &addressLength);
+	_port = ntohs(address.sin_port);
+
+	//the wake socket sends to itself on the loopback address
+	SOCKET wakeSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	sockaddr_in wakeAddress = {};
+	wakeAddress.sin_family = AF_INET;
+	wakeAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	wakeAddress.sin_port = 0;
+	addressLength = sizeof(wakeAddress);
+	if (wakeSocket == INVALID_SOCKET or bind(wakeSocket, reinterpret_cast<sockaddr*>(&wakeAddress), sizeof(wakeAddress)) == SOCKET_ERROR
+		or getsockname(wakeSocket, reinterpret_cast<sockaddr*>(&wakeAddress), &addressLength) == SOCKET_ERROR
+		or connect(wakeSocket, reinterpret_cast<sockaddr*>(&wakeAddress), sizeof(wakeAddress)) == SOCKET_ERROR)
+	{
+		if (wakeSocket != INVALID_SOCKET)
+		{
+			closesocket(wakeSocket);
+		}
+		closesocket(listener);
+		WSACleanup();
+		throw new Exception(1, "[BROADCAST] wake socket error.");
+	}
+
+	ioctlsocket(wakeSocket, FIONBIO, &nonBlocking);
+
+	_listener = static_cast<SocketHandle>(listener);
+	_wakeSocket = static_cast<SocketHandle>(wakeSocket);
+	_thread = std::thread(&BroadcastServer::ServerLoop, this);
+}
+
+BroadcastServer::~BroadcastServer()
+{
+	_stopping = true;
+	Wake();
+	_thread.join();
+
+	for (Viewer& viewer : _viewers)
+	{
+		closesocket(static_cast<SOCKET>(viewer.socket));
+	}
+
+	closesocket(static_cast<SOCKET>(_listener));
+	closesocket(static_cast<SOCKET>(_wakeSocket));
+	WSACleanup();
+}
+
+void BroadcastServer::ServerLoop()
+{
+	std::vector<WSAPOLLFD> polled;
+	std::vector<PendingFrame> frames;
+
+	while (!_stopping)
+	{
+		polled.clear();
+		polled.push_back({ static_cast<SOCKET>(_listener), POLLRDNORM, 0 });
+		polled.push_back({ static_cast<SOCKET>(_wakeSocket), POLLRDNORM, 0 });
+
+		for (const Viewer& viewer : _viewers)
+		{
+			//a viewer is polled for writing only while it has something queued
+			polled.push_back({ static_cast<SOCKET>(viewer.socket), static_cast<short>(POLLRDNORM | (viewer.queue.empty() ? 0 : POLLWRNORM)), 0 });
+		}
+
+		WSAPoll(polled.data(), static_cast<unsigned long>(polled.size()), 100);
+
+		if (polled[1].revents & POLLRDNORM)
+		{
+			while (recv(static_cast<SOCKET>(_wakeSocket), _readBuffer.data(), static_cast<int>(_readBuffer.size()), 0) > 0) {}
+			_wakePending = false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_pendingMutex);
+			frames.swap(_pending);
+		}
+
+		if (!frames.empty())
+		{
+			Distribute(frames);
+			frames.clear();
+		}
+
+		//viewers that only became writable (or closed) since the last frame; the vector lines up with polled from index 2
+		for (size_t i = 0; i < _viewers.size() and i + 2 < polled.size(); i++)
+		{
+			short events = polled[i + 2].revents;
+			if (events == 0 or _viewers[i].socket == static_cast<SocketHandle>(INVALID_SOCKET))
+			{
+				continue;
+			}
+
+			if (events & (POLLERR | POLLHUP | POLLNVAL))
+			{
+				Close(_viewers[i]);
+				continue;
+			}
+
+			if (events & POLLRDNORM)
+			{
+				int received = recv(static_cast<SOCKET>(_viewers[i].socket), _readBuffer.data(), static_cast<int>(_readBuffer.size()), 0);
+				if (received == 0 or (received == SOCKET_ERROR and WSAGetLastError() != WSAEWOULDBLOCK))
+				{
+					Close(_viewers[i]);
+					continue;
+				}
+			}
+
+			if ((events & POLLWRNORM) and !Send(_viewers[i]))
+			{
+				Close(_viewers[i]);
+			}
+		}
+
+		//closed viewers are removed after the loop, so indices stay in line with polled above
+		for (size_t i = 0; i < _viewers.size(); )
+		{
+			if (_viewers[i].socket == static_cast<SocketHandle>(INVALID_SOCKET))
+			{
+				_viewers[i] = std::move(_viewers.back());
+				_viewers.pop_back();
+			}
+			else
+			{
+				i++;
+			}
+		}
+
+		if (polled[0].revents & POLLRDNORM)
+		{
+			Accept();
+		}
+
+		_viewersNumber = static_cast<int>(_viewers.size());
+	}
+}
+
+void BroadcastServer::Accept()
+{
+	while (true)
+	{
+		SOCKET socket = accept(static_cast<SOCKET>(_listener), nullptr, nullptr);
+		if (socket == INVALID_SOCKET)
+		{
+			return;
+		}
+
+		u_long nonBlocking = 1;
+		ioctlsocket(socket, FIONBIO, &nonBlocking);
+		int noDelay = 1;
+		setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+		//a small socket buffer keeps a lagging viewer's backlog in its queue, where it is measured and resynced
+		int sendBufferBytes = 16 * 1024;
+		setsockopt(socket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&sendBufferBytes), sizeof(sendBufferBytes));
+
+		Viewer viewer;
+		viewer.socket = static_cast<SocketHandle>(socket);
+		viewer.queuedBytes = 0;
+		viewer.frontSent = 0;
+		viewer.waitingForKeyframe = true;
+		viewer.resyncs = 0;
+		_viewers.push_back(std::move(viewer));
+
+		//counted before the keyframe is asked for, so the publisher sends the frames after the keyframe too
+		_viewersNumber = static_cast<int>(_viewers.size());
+		_keyframeWanted = true;
+
+		std::lock_guard<std::mutex> lock(_statisticsMutex);
+		_accepted++;
+	}
+}
+
+void BroadcastServer::Distribute(std::vector<PendingFrame>& frames)
+{
+	for (PendingFrame& frame : frames)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		long long bytesSent = 0;
+		bool keyframeWanted = false;
+
+		for (Viewer& viewer : _viewers)
+		{
+			if (viewer.socket == static_cast<SocketHandle>(INVALID_SOCKET) or viewer.waitingForKeyframe != frame.keyframe)
+			{
+				keyframeWanted = keyframeWanted or viewer.waitingForKeyframe;
+				continue;
+			}
+
+			viewer.waitingForKeyframe = false;
+			viewer.queue.push_back(frame.buffer);
+			viewer.queuedBytes += frame.buffer->size();
+
+			size_t queuedBefore = viewer.queuedBytes;
+			if (!Send(viewer))
+			{
+				Close(viewer);
+				continue;
+			}
+			bytesSent += static_cast<long long>(queuedBefore - viewer.queuedBytes);
+
+			if (viewer.queuedBytes > _maxQueuedBytes)
+			{
+				Resync(viewer);
+				keyframeWanted = keyframeWanted or viewer.waitingForKeyframe;
+			}
+		}
+
+		_keyframeWanted = keyframeWanted;
+
+		std::lock_guard<std::mutex> lock(_statisticsMutex);
+		_fanOut.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+		_bytesSent += bytesSent;
+	}
+}
+
+bool BroadcastServer::Send(Viewer& viewer)
+{
+	while (!viewer.queue.empty())
+	{
+		const std::string& buffer = *viewer.queue.front();
+		int sent = send(static_cast<SOCKET>(viewer.socket), buffer.data() + viewer.frontSent, static_cast<int>(buffer.size() - viewer.frontSent), 0);
+
+		if (sent == SOCKET_ERROR)
+		{
+			return WSAGetLastError() == WSAEWOULDBLOCK;
+		}
+
+		viewer.frontSent += sent;
+		viewer.queuedBytes -= sent;
+
+		if (viewer.frontSent == buffer.size())
+		{
+			viewer.queue.pop_front();
+			viewer.frontSent = 0;
+		}
+	}
+
+	return true;
+}
+
+void BroadcastServer::Resync(Viewer& viewer)
+{
+	if (viewer.resyncs >= _maxResyncs)
+	{
+		Close(viewer);
+		return;
+	}
+
+	//a frame that is partly sent has to be finished, or the terminal gets half an escape sequence
+	FrameBuffer front = viewer.frontSent > 0 ? viewer.queue.front() : nullptr;
+	viewer.queue.clear();
+	viewer.queuedBytes = 0;
+
+	if (front != nullptr)
+	{
+		viewer.queue.push_back(front);
+		viewer.queuedBytes = front->size() - viewer.frontSent;
+	}
+
+	viewer.waitingForKeyframe = true;
+	viewer.resyncs++;
+
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	_resyncs++;
+}
+
+void BroadcastServer::Close(Viewer& viewer)
+{
+	closesocket(static_cast<SOCKET>(viewer.socket));
+	viewer.socket = static_cast<SocketHandle>(INVALID_SOCKET);
+	viewer.queue.clear();
+	viewer.queuedBytes = 0;
+
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+	_dropped++;
+}
+
+void BroadcastServer::Publish(const std::string& text, const bool& keyframe)
+{
+	FrameBuffer buffer = std::make_shared<const std::string>(text);
+
+	{
+		std::lock_guard<std::mutex> lock(_pendingMutex);
+		_pending.push_back({ buffer, keyframe });
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_statisticsMutex);
+		(keyframe ? _keyframes : _frames)++;
+		_frameBytes += static_cast<long long>(text.size());
+	}
+
+	Wake();
+}
+
+void BroadcastServer::PublishFrame(const std::string& changes)
+{
+	Publish(changes, false);
+}
+
+void BroadcastServer::PublishKeyframe(const std::string& screen)
+{
+	_keyframeWanted = false; //set again by the server thread if a viewer still waits after it
+	Publish(screen, true);
+}
+
+void BroadcastServer::Wake()
+{
+	//one datagram is enough until the server thread has read it
+	if (!_wakePending.exchange(true))
+	{
+		char wake = 0;
+		send(static_cast<SOCKET>(_wakeSocket), &wake, 1, 0);
+	}
+}
+
+int BroadcastServer::Port() const
+{
+	return _port;
+}
+
+int BroadcastServer::Viewers() const
+{
+	return _viewersNumber;
+}
+
+bool BroadcastServer::KeyframeWanted() const
+{
+	return _keyframeWanted;
+}
+
+void BroadcastServer::Report(std::ostream& reportStream) const
+{
+	std::lock_guard<std::mutex> lock(_statisticsMutex);
+
+	reportStream << std::fixed << std::setprecision(2);
+	reportStream << "broadcast: " << _frames << " frames and " << _keyframes << " keyframes encoded once (" << _frameBytes / 1024.0 << " KB), " << _bytesSent / 1024.0 << " KB sent to viewers\n";
+	reportStream << "viewers: " << _accepted << " accepted, " << _resyncs << " resynced, " << _dropped << " closed or dropped\n";
+	reportStream << "fan-out per frame [us]: mean " << _fanOut.Mean() / 1000.0 << ", p50 " << _fanOut.Percentile(50) / 1000.0 << ", p99 " << _fanOut.Percentile(99) / 1000.0 << ", max " << _fanOut.Max() / 1000.0 << "\n";
+}
+
+LocalViewers::LocalViewers(const int& port, const int& viewers, const int& stalled)
+{
+	WSADATA data;
+	if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+	{
+		throw new Exception(1, "[BROADCAST] winsock startup error.");
+	}
+
+	_stalled = stalled;
+	_stopping = false;
+
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(static_cast<unsigned short>(port));
+
+	for (int i = 0; i < viewers; i++)
+	{
+		SOCKET viewer = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+		//stalled viewers get a small window, so their backlog ends up in the server's queue soon
+		if (i < stalled)
+		{
+			int windowBytes = 4096;
+			setsockopt(viewer, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&windowBytes), sizeof(windowBytes));
+		}
+
+		if (viewer == INVALID_SOCKET or connect(viewer, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR)
+		{
+			if (viewer != INVALID_SOCKET)
+			{
+				closesocket(viewer);
+			}
+			break;
+		}
+
+		u_long nonBlocking = 1;
+		ioctlsocket(viewer, FIONBIO, &nonBlocking);
+		_sockets.push_back(static_cast<SocketHandle>(viewer));
+	}
+
+	_received = std::vector<long long>(_sockets.size(), 0);
+	_closed = std::vector<bool>(_sockets.size(), false);
+	_reader = std::thread(&LocalViewers::ReadLoop, this);
+}
+
+LocalViewers::~LocalViewers()
+{
+	Stop();
+
+	for (const SocketHandle& viewer : _sockets)
+	{
+		closesocket(static_cast<SOCKET>(viewer));
+	}
+
+	WSACleanup();
+}
+
+void LocalViewers::ReadLoop()
+{
+	std::vector<char> buffer(64 * 1024);
+	std::vector<WSAPOLLFD> polled;
+	std::vector<int> indices;
+
+	while (!_stopping)
+	{
+		polled.clear();
+		indices.clear();
+
+		for (int i = _stalled; i < static_cast<int>(_sockets.size()); i++)
+		{
+			if (!_closed[i])
+			{
+				polled.push_back({ static_cast<SOCKET>(_sockets[i]), POLLRDNORM, 0 });
+				indices.push_back(i);
+			}
+		}
+
+		if (polled.empty())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			continue;
+		}
+
+		WSAPoll(polled.data(), static_cast<unsigned long>(polled.size()), 10);
+
+		for (size_t j = 0; j < polled.size(); j++)
+		{
+			if (polled[j].revents == 0)
+			{
+				continue;
+			}
+
+			int i = indices[j];
+			int received = recv(static_cast<SOCKET>(_sockets[i]), buffer.data(), static_cast<int>(buffer.size()), 0);
+			if (received > 0)
+			{
+				_received[i] += received;
+			}
+			else if (received == 0 or WSAGetLastError() != WSAEWOULDBLOCK)
+			{
+				_closed[i] = true;
+			}
+		}
+	}
+}
+
+void LocalViewers::Stop()
+{
+	if (_reader.joinable())
+	{
+		_stopping = true;
+		_reader.join();
+	}
+
+	//stalled viewers learn that they were dropped only now
+	std::vector<char> buffer(64 * 1024);
+	for (int i = 0; i < _stalled and i < static_cast<int>(_sockets.size()); i++)
+	{
+		int received = 0;
+		do
+		{
+			received = recv(static_cast<SOCKET>(_sockets[i]), buffer.data(), static_cast<int>(buffer.size()), 0);
+		} while (received > 0);
+
+		_closed[i] = received == 0 or WSAGetLastError() != WSAEWOULDBLOCK;
+	}
+}
+
+int LocalViewers::Closed() const
+{
+	int closed = 0;
+	for (const bool& viewerClosed : _closed)
+	{
+		closed += viewerClosed ? 1 : 0;
+	}
+
+	return closed;
+}
+
+long long LocalViewers::MinReceived() const
+{
+	long long minimum = -1;
+	for (int i = _stalled; i < static_cast<int>(_received.size()); i++)
+	{
+		if (minimum < 0 or _received[i] < minimum)
+		{
+			minimum = _received[i];
+		}
+	}
+
+	return minimum < 0 ? 0 : minimum;
+}
+
+long long LocalViewers::MaxReceived() const
+{
+	long long maximum = 0;
+	for (int i = _stalled; i < static_cast<int>(_received.size()); i++)
+	{
+		if (_received[i] > maximum)
+		{
+			maximum = _received[i];
+		}
+	}
+
+	return maximum;
+}
+
+long long LocalViewers::Received() const
+{
+	long long received = 0;
+	for (const long long& viewerReceived : _received)
+	{
+		received += viewerReceived;
+	}
+
+	return received;
+}
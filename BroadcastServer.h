@@ -0,0 +1,112 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+#include "Exception.h"
+#include "LatencyHistogram.h"
+
+// spectators: presented frames are streamed to read-only viewers over TCP, any ANSI terminal (telnet, nc) can watch
+// every frame is encoded once into a shared buffer all viewer queues point to, a server thread writes the queues;
+// a new viewer, or one whose queue grew over the limit, gets a keyframe (the whole screen) and the frames after it
+
+typedef uintptr_t SocketHandle; //SOCKET - winsock2 is included only in .cpp files, it has to come before Windows.h
+
+class BroadcastServer
+{
+private:
+	typedef std::shared_ptr<const std::string> FrameBuffer;
+
+	struct Viewer
+	{
+		SocketHandle socket;
+		std::deque<FrameBuffer> queue;
+		size_t queuedBytes;
+		size_t frontSent; //bytes of queue.front() already sent
+		bool waitingForKeyframe; //frames are skipped until the next keyframe
+		int resyncs;
+	};
+
+	struct PendingFrame
+	{
+		FrameBuffer buffer;
+		bool keyframe;
+	};
+
+	SocketHandle _listener;
+	SocketHandle _wakeSocket; //udp socket bound to itself, a datagram wakes the server thread from polling
+	int _port;
+	size_t _maxQueuedBytes; //a viewer with more unsent bytes is resynced
+	int _maxResyncs; //a viewer that needs more resyncs is dropped
+
+	//server thread
+	std::vector<Viewer> _viewers;
+	std::vector<char> _readBuffer; //viewers are read-only, whatever they send is read and dropped
+
+	//shared
+	std::mutex _pendingMutex;
+	std::vector<PendingFrame> _pending; //published, not yet queued to the viewers
+	std::atomic<bool> _keyframeWanted;
+	std::atomic<bool> _wakePending;
+	std::atomic<int> _viewersNumber;
+	std::atomic<bool> _stopping;
+	std::thread _thread;
+
+	mutable std::mutex _statisticsMutex;
+	long long _frames;
+	long long _keyframes;
+	long long _frameBytes; //encoded once per frame
+	long long _bytesSent; //to all viewers
+	long long _accepted;
+	long long _resyncs;
+	long long _dropped;
+	LatencyHistogram _fanOut; //from taking a frame to having offered it to every viewer's socket
+
+	void ServerLoop();
+	void Accept();
+	void Distribute(std::vector<PendingFrame>& frames);
+	bool Send(Viewer& viewer); //writes as much of the queue as the socket takes, false if the viewer is gone
+	void Resync(Viewer& viewer);
+	void Close(Viewer& viewer);
+	void Publish(const std::string& text, const bool& keyframe);
+	void Wake();
+
+public:
+	BroadcastServer(const int& port, const size_t& maxQueuedBytes = 256 * 1024, const int& maxResyncs = 3, const std::string& bindAddress = "127.0.0.1"); //port 0 - any free port, bindAddress - IPv4 address to listen on, "0.0.0.0" - every interface
+	~BroadcastServer(); //closes every viewer
+	int Port() const;
+	int Viewers() const;
+	bool KeyframeWanted() const; //a viewer waits for a keyframe, the publisher sends one with its next frame
+	void PublishFrame(const std::string& changes); //what changed on the screen since the previous frame
+	void PublishKeyframe(const std::string& screen); //the whole screen as it is after the last published frame
+	void Report(std::ostream& reportStream) const;
+};
+
+class LocalViewers //load test: connects viewers to a broadcast server on this machine and reads them all on one thread
+{
+private:
+	std::vector<SocketHandle> _sockets;
+	std::vector<long long> _received; //bytes read per viewer
+	std::vector<bool> _closed; //closed by the server
+	int _stalled; //the first viewers never read, the server has to resync and drop them
+	std::atomic<bool> _stopping;
+	std::thread _reader;
+
+	void ReadLoop();
+
+public:
+	LocalViewers(const int& port, const int& viewers, const int& stalled = 0);
+	~LocalViewers();
+	void Stop(); //stops reading, the counts below are final after it
+	int Closed() const; //viewers the server closed
+	long long MinReceived() const; //of the viewers that read
+	long long MaxReceived() const;
+	long long Received() const;
+};
@@ -0,0 +1,142 @@
+#include "ChunkGenerator.h"
+
+ChunkGenerator::ChunkGenerator(const int& seed, const int& width, const int& height)
+{
+	if (width < MIN_WIDTH or height < MIN_HEIGHT)
+	{
+		throw new Exception(0, "[LEVEL] endless chunks are too small.");
+	}
+
+	_seed = seed;
+	_width = width;
+	_height = height;
+}
+
+std::string ChunkGenerator::Generate(const int& index) const
+{
+	const std::string wall = ".c/f7/b7";
+	const std::string air = ".f0/b0";
+	const std::string spikes = "^d1/f1/b0";
+	const std::string gold = "$g1,46,0,0/f3/b0";
+
+	std::seed_seq seeds = { static_cast<unsigned int>(_seed), static_cast<unsigned int>(index) };
+	std::mt19937 generator(seeds);
+	std::vector<std::vector<std::string>> tiles(_height, std::vector<std::string>(_width, air)); //[y][x]
+
+	for (int x = 0; x < _width; x++)
+	{
+		tiles[0][x] = wall;
+		tiles[_height - 1][x] = wall;
+	}
+
+	for (int y = 0; y < _height; y++)
+	{
+		tiles[y][0] = wall;
+		tiles[y][_width - 1] = wall;
+	}
+
+	//the exit column leads to the next chunk
+	Position entry = Entry();
+	for (int y = 1; y < _height - 1; y++)
+	{
+		tiles[y][_width - 2] = air + "/s" + std::to_string(index + 1) + "," + std::to_string(entry.x) + "," + std::to_string(entry.y);
+	}
+
+	//obstacles between the entry and the exit, each one low and short enough to be jumped (the jump is 4 cells)
+	int ground = _height - 2; //lowest free row
+	int x = 6;
+	while (x < _width - 8)
+	{
+		int length = 0;
+		switch (generator() % 5)
+		{
+		case 0: //ledge, gold on top now and then
+		{
+			int height = 1 + static_cast<int>(generator() % 2);
+			length = std::min(4 + static_cast<int>(generator() % 7), _width - 8 - x);
+			bool golden = generator() % 2 == 0;
+			for (int i = x; i < x + length; i++)
+			{
+				for (int y = ground; y > ground - height; y--)
+				{
+					tiles[y][i] = wall;
+				}
+
+				if (golden)
+				{
+					tiles[ground - height][i] = gold;
+				}
+			}
+
+			break;
+		}
+
+		case 1: //spikes
+			length = 1 + static_cast<int>(generator() % 2);
+			for (int i = x; i < x + length and i < _width - 8; i++)
+			{
+				tiles[ground][i] = spikes;
+			}
+
+			break;
+
+		case 2: //spikes that come and go
+		{
+			length = 1 + static_cast<int>(generator() % 3);
+			int period = 30 + static_cast<int>(generator() % 61);
+			int offset = static_cast<int>(generator() % period);
+			for (int i = x; i < x + length and i < _width - 8; i++)
+			{
+				tiles[ground][i] = "^d1/t" + std::to_string(static_cast<int>(OPTION::DEAL_DMG)) + "," + std::to_string(period) + ",46," + std::to_string(offset) + "/f1/b0";
+			}
+
+			break;
+		}
+
+		case 3: //gold in the air, taken on the way or with a jump
+		{
+			length = 3 + static_cast<int>(generator() % 4);
+			int y = ground - 1 - static_cast<int>(generator() % 3);
+			for (int i = x; i < x + length and i < _width - 8; i++)
+			{
+				tiles[y][i] = gold;
+			}
+
+			break;
+		}
+
+		default: //nothing
+			length = 2 + static_cast<int>(generator() % 4);
+			break;
+		}
+
+		x += length + 1 + static_cast<int>(generator() % 3);
+	}
+
+	std::ostringstream mapText;
+	mapText << _width << " " << _height << "\n";
+	for (const std::vector<std::string>& row : tiles)
+	{
+		for (int i = 0; i < _width; i++)
+		{
+			mapText << row[i] << (i + 1 < _width ? " " : "\n");
+		}
+	}
+
+	return mapText.str();
+}
+
+Position ChunkGenerator::Entry() const
+{
+	return { 1, _height - 4 };
+}
+
+int ChunkGenerator::GetWidth() const
+{
+	return _width;
+}
+
+int ChunkGenerator::GetHeight() const
+{
+	return _height;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <random>
+#include <sstream>
+#include <algorithm>
+#include "Position.h"
+#include "Exception.h"
+#include "Option.h"
+
+// rooms of an endless level: chunk i of a seed is the .map text of one room, the same on every machine (mt19937 is fully
+// specified and only its raw output is used) - ground with ledges, spikes, timed spikes and gold, walked through left to right
+// the last free column switches to chunk i + 1, so a chunk is loaded like any other room
+
+class ChunkGenerator
+{
+private:
+	int _seed;
+	int _width;
+	int _height;
+
+public:
+	static const int MIN_WIDTH = 20;
+	static const int MIN_HEIGHT = 8;
+
+	ChunkGenerator(const int& seed, const int& width, const int& height);
+	std::string Generate(const int& index) const; //.map text of chunk index
+	Position Entry() const; //top left of the player's body when it comes in, room for a body 3 cells wide and tall
+	int GetWidth() const;
+	int GetHeight() const;
+};
@@ -0,0 +1,170 @@
+#include "ChunkStream.h"
+
+ChunkStream::ChunkStream(const int& seed, const int& width, const int& height, const int& ahead, const int& threads)
+	: _generator(seed, width, height), _pool(threads)
+{
+	_ahead = ahead;
+	_generated = 0;
+	_generationNanoseconds = 0;
+	_requests = 0;
+	_stalls = 0;
+	_marginSum = 0;
+	_minMargin = -1;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (int i = 0; i <= _ahead; i++)
+	{
+		Schedule(i);
+	}
+}
+
+void ChunkStream::Schedule(const int& index)
+{
+	if (index < 0 or _chunks.find(index) != _chunks.end())
+	{
+		return;
+	}
+
+	_chunks[index] = nullptr;
+	_pool.Submit([this, index]() { Generate(index); });
+}
+
+void ChunkStream::Generate(const int& index)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::shared_ptr<const Map> chunk;
+	std::exception_ptr error;
+
+	//a throw on the worker would end the process or leave Get waiting forever, so it is handed to the game thread
+	try
+	{
+		std::istringstream mapStream(_generator.Generate(index));
+
+		//chunks outlive the room that asked for them, so they never come from its arena
+		ArenaScope scope(nullptr);
+		chunk = std::make_shared<const Map>(mapStream);
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+
+	long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_generated++;
+	_generationNanoseconds += nanoseconds;
+
+	//forgotten while it was generated - the player went elsewhere
+	std::map<int, std::shared_ptr<const Map>>::iterator entry = _chunks.find(index);
+	if (entry != _chunks.end())
+	{
+		if (error)
+		{
+			_errors[index] = error;
+		}
+		else
+		{
+			entry->second = chunk;
+		}
+
+		_chunkReady.notify_all();
+	}
+}
+
+std::shared_ptr<const Map> ChunkStream::Get(const int& index)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	//the previous chunk stays for a step back, everything else behind or too far ahead goes
+	for (std::map<int, std::shared_ptr<const Map>>::iterator entry = _chunks.begin(); entry != _chunks.end();)
+	{
+		if (entry->first < index - 1 or entry->first > index + _ahead)
+		{
+			_errors.erase(entry->first);
+			entry = _chunks.erase(entry);
+		}
+		else
+		{
+			++entry;
+		}
+	}
+
+	for (int i = index; i <= index + _ahead; i++)
+	{
+		Schedule(i);
+	}
+
+	//the first chunk is always waited for when the level starts, the rooms entered later should not be
+	if (index > 0)
+	{
+		int margin = 0;
+		while (margin < _ahead and _chunks[index + 1 + margin] != nullptr)
+		{
+			margin++;
+		}
+
+		_requests++;
+		_marginSum += margin;
+		_minMargin = _minMargin == -1 ? margin : std::min(_minMargin, margin);
+		_stalls += _chunks[index] == nullptr;
+	}
+
+	if (_chunks[index] == nullptr)
+	{
+		_chunkReady.wait(lock, [this, index]() { return _chunks[index] != nullptr or _errors.find(index) != _errors.end(); });
+	}
+
+	//thrown where it was asked for; the chunk is forgotten, so asking again generates it again
+	std::map<int, std::exception_ptr>::iterator failure = _errors.find(index);
+	if (failure != _errors.end())
+	{
+		std::exception_ptr error = failure->second;
+		_errors.erase(failure);
+		_chunks.erase(index);
+		std::rethrow_exception(error);
+	}
+
+	return _chunks[index];
+}
+
+const ChunkGenerator& ChunkStream::GetGenerator() const
+{
+	return _generator;
+}
+
+long long ChunkStream::Generated()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _generated;
+}
+
+double ChunkStream::GenerationMicroseconds()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _generated > 0 ? _generationNanoseconds / 1000.0 / _generated : 0.0;
+}
+
+long long ChunkStream::Requests()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _requests;
+}
+
+long long ChunkStream::Stalls()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _stalls;
+}
+
+double ChunkStream::MeanMargin()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _requests > 0 ? static_cast<double>(_marginSum) / _requests : 0.0;
+}
+
+int ChunkStream::MinMargin()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _minMargin;
+}
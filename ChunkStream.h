@@ -0,0 +1,46 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <exception>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include "ChunkGenerator.h"
+#include "Map.h"
+#include "WorkStealingPool.h"
+
+// chunks of an endless level generated and parsed on worker threads ahead of the player
+// asking for chunk i keeps chunks i + 1 .. i + ahead coming, so entering the next room only copies a parsed map;
+// chunks behind the player are forgotten and generated again (the same) if it ever goes back, e.g. by rewinding
+
+class ChunkStream
+{
+private:
+	ChunkGenerator _generator;
+	int _ahead;
+	std::map<int, std::shared_ptr<const Map>> _chunks; //nullptr - still being generated or failed
+	std::map<int, std::exception_ptr> _errors; //what generating a chunk threw, rethrown by Get
+	std::mutex _mutex;
+	std::condition_variable _chunkReady;
+	long long _generated;
+	long long _generationNanoseconds; //of all generated chunks, summed over the workers
+	long long _requests; //of chunks after the first
+	long long _stalls; //requests that had to wait for their chunk
+	long long _marginSum; //chunks ready ahead of the requested one, summed over requests
+	int _minMargin;
+	WorkStealingPool _pool; //last - its threads are joined before the rest goes away
+
+	void Schedule(const int& index); //under _mutex
+	void Generate(const int& index); //on a worker
+
+public:
+	ChunkStream(const int& seed, const int& width, const int& height, const int& ahead, const int& threads);
+	std::shared_ptr<const Map> Get(const int& index); //waits only if the chunk is not ready yet, throws what generating it threw
+	const ChunkGenerator& GetGenerator() const;
+	long long Generated();
+	double GenerationMicroseconds(); //mean per chunk
+	long long Requests(); //rooms entered after the first
+	long long Stalls();
+	double MeanMargin();
+	int MinMargin(); //-1 - nothing was requested yet
+};
@@ -0,0 +1,70 @@
+#include "EffectQueue.h"
+
+EffectQueue::EffectQueue()
+{
+	_hudOutdated = false;
+	_roomEntered = false;
+	_recorded = 0;
+	_run = 0;
+}
+
+void EffectQueue::PlaySound(const SOUND& sound)
+{
+	_recorded++;
+
+	for (std::vector<SOUND>::iterator queued = _sounds.begin(); queued != _sounds.end(); ++queued)
+	{
+		if (*queued == sound)
+		{
+			_sounds.erase(queued);
+			break;
+		}
+	}
+
+	_sounds.push_back(sound);
+}
+
+void EffectQueue::UpdateHud()
+{
+	_recorded++;
+	_hudOutdated = true;
+}
+
+void EffectQueue::ShowRoom()
+{
+	_recorded++;
+	_roomEntered = true;
+}
+
+const std::vector<SOUND>& EffectQueue::Sounds() const
+{
+	return _sounds;
+}
+
+bool EffectQueue::HudOutdated() const
+{
+	return _hudOutdated;
+}
+
+bool EffectQueue::RoomEntered() const
+{
+	return _roomEntered;
+}
+
+void EffectQueue::Finish()
+{
+	_run += static_cast<long long>(_sounds.size()) + (_hudOutdated ? 1 : 0) + (_roomEntered ? 1 : 0);
+	_sounds.clear();
+	_hudOutdated = false;
+	_roomEntered = false;
+}
+
+long long EffectQueue::Recorded() const
+{
+	return _recorded;
+}
+
+long long EffectQueue::Run() const
+{
+	return _run;
+}
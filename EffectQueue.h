@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include "Sound.h"
+
+// what the triggers of one tick ask the game to do besides changing its state: sounds, the HUD and showing a room the player entered
+// they are recorded while the tick runs and done once at its end, so touching several pickups or hazards in one tick
+// plays each sound once, draws the HUD once and shows a room once
+
+class EffectQueue
+{
+private:
+	std::vector<SOUND> _sounds; //each one once, where it was last asked for - a sound cuts off the one before, so the last one is heard as before
+	bool _hudOutdated;
+	bool _roomEntered;
+	long long _recorded; //every effect asked for
+	long long _run; //the ones left after merging
+
+public:
+	EffectQueue();
+	void PlaySound(const SOUND& sound);
+	void UpdateHud();
+	void ShowRoom();
+	const std::vector<SOUND>& Sounds() const;
+	bool HudOutdated() const;
+	bool RoomEntered() const;
+	void Finish(); //the game did the effects of the tick, forgets them
+	long long Recorded() const;
+	long long Run() const;
+};
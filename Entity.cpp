@@ -25,7 +25,7 @@ std::vector<EntityTile> Entity::GetBody() const
 	return _body;
 }
 
-std::vector<Position> Entity::GetCollidingPositions() const
+const std::vector<Position>& Entity::GetCollidingPositions() const
 {
 	return _collidingPositions;
 }
@@ -64,6 +64,8 @@ void Entity::SetPosition(Position& position)
 	{
 		tile.SetPosition(tile.GetPosition() + deltaPosition);
 	}
+
+	SetCollidingPositions();
 }
 
 Position Entity::TopLeft() const
@@ -2,7 +2,7 @@
 
 EntityTile::EntityTile(const char& character, const Position& position, const std::vector<Option>& options, const std::string& tileColor, const std::string& backgroundColor): Tile(character, position, tileColor, backgroundColor)
 {
-	_options = options;
+	_options.assign(options.begin(), options.end());
 }
 
 EntityTile::~EntityTile() {}
@@ -20,9 +20,27 @@ Option EntityTile::GetOption(const OPTION& optionName) const
 	return { OPTION::OPTION_ERROR, {} };
 }
 
+bool EntityTile::HasOption(const OPTION& optionName) const
+{
+	for (const Option& option : _options)
+	{
+		if (option.optionName == optionName)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 std::vector<Option> EntityTile::GetOptions() const
 {
-	return _options;
+	return std::vector<Option>(_options.begin(), _options.end());
+}
+
+bool EntityTile::HasOptions() const
+{
+	return !_options.empty();
 }
 
 void EntityTile::RemoveOption(const OPTION& optionName)
@@ -34,4 +52,44 @@ void EntityTile::RemoveOption(const OPTION& optionName)
 			_options.erase(_options.begin() + i);
 		}
 	}
-}
\ No newline at end of file
+}
+
+void EntityTile::AddOption(const Option& option)
+{
+	_options.push_back(option);
+}
+
+bool EntityTile::SameAs(const EntityTile& other) const
+{
+	if (_character != other._character or _tileColor != other._tileColor or _backgroundColor != other._backgroundColor or _options.size() != other._options.size())
+	{
+		return false;
+	}
+
+	for (int i = 0; i < static_cast<int>(_options.size()); i++)
+	{
+		if (_options[i].optionName != other._options[i].optionName or _options[i].arguments != other._options[i].arguments)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t EntityTile::Hash() const
+{
+	size_t hash = std::hash<std::string>()(_tileColor) * 31 + std::hash<std::string>()(_backgroundColor);
+	hash = hash * 31 + static_cast<unsigned char>(_character);
+
+	for (const Option& option : _options)
+	{
+		hash = hash * 31 + static_cast<size_t>(option.optionName) + 1;
+		for (const int& argument : option.arguments)
+		{
+			hash = hash * 31 + static_cast<size_t>(argument);
+		}
+	}
+
+	return hash;
+}
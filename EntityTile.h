@@ -5,13 +5,18 @@
 class EntityTile : public Tile
 {
 private:
-	std::vector<Option> _options;
+	std::vector<Option, ArenaAllocator<Option, MEMORY_TAG::OPTIONS>> _options;
 
 public:
 	EntityTile(const char& character, const Position& position, const std::vector<Option>& options, const std::string& tileColor = "\u001b[37m" /*white*/, const std::string& backgroundColor = "\u001b[30m"/*black*/);
 	virtual ~EntityTile();
 	Option GetOption(const OPTION& optionName) const; // returns option with optionName = OPTION_ERROR if not found
+	bool HasOption(const OPTION& optionName) const; // without copying the option's arguments
 	std::vector<Option> GetOptions() const;
+	bool HasOptions() const;
 	void RemoveOption(const OPTION& optionName);
+	void AddOption(const Option& option);
+	bool SameAs(const EntityTile& other) const; //the same character, colors and options, wherever they are
+	size_t Hash() const; //equal for tiles that are SameAs
 };
 
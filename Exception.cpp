@@ -12,6 +12,11 @@ void Exception::Display() const
 	std::cout << "\nERROR NUMBER: " << _exceptionNumber << ".\nMESSAGE: " << _exceptionMessage << "\n";
 }
 
+std::string Exception::Message() const
+{
+	return _exceptionMessage;
+}
+
 void Exception::Unknown()
 {
 	system("cls");
@@ -19,6 +19,7 @@ private:
 public:
 	Exception(int exceptionNumber, std::string exceptionMessage);
 	void Display() const;
+	std::string Message() const;
 	static void Unknown();
 };
 
@@ -0,0 +1,249 @@
+#include "FieldOfView.h"
+
+FieldOfView::FieldOfView(const int& width, const int& height, const int& radius)
+{
+	_width = width;
+	_height = height;
+	_radius = radius;
+	_rowWords = (width + 63) / 64;
+	if (Dark())
+	{
+		_opaque.assign(_rowWords * height, 0);
+		_visible.assign(_rowWords * height, 0);
+		_previous.assign(_rowWords * height, 0);
+		_explored.assign(_rowWords * height, 0);
+	}
+
+	_visibleBox = { 0, -1, 0, -1 };
+	_previousBox = { 0, -1, 0, -1 };
+	_eye = { -1, -1 };
+	_cast = false;
+	_dirty = false;
+	_casts = 0;
+}
+
+bool FieldOfView::Test(const Bitset& bits, const int& x, const int& y) const
+{
+	return (bits[y * _rowWords + x / 64] >> (x % 64)) & 1;
+}
+
+void FieldOfView::Set(Bitset& bits, const int& x, const int& y)
+{
+	bits[y * _rowWords + x / 64] |= 1ULL << (x % 64);
+}
+
+FieldOfView::Box FieldOfView::BoxAround(const Position& eye) const
+{
+	Box box;
+	box.top = std::max(0, eye.y - _radius);
+	box.bottom = std::min(_height - 1, eye.y + _radius);
+	box.firstWord = std::max(0, eye.x - _radius) / 64;
+	box.lastWord = std::min(_width - 1, eye.x + _radius) / 64;
+	if (eye.x + _radius < 0)
+	{
+		box.lastWord = -1;
+	}
+
+	return box;
+}
+
+void FieldOfView::ClearBox(Bitset& bits, const Box& box)
+{
+	for (int y = box.top; y <= box.bottom; y++)
+	{
+		for (int word = box.firstWord; word <= box.lastWord; word++)
+		{
+			bits[y * _rowWords + word] = 0;
+		}
+	}
+}
+
+bool FieldOfView::Dark() const
+{
+	return _radius > 0;
+}
+
+int FieldOfView::GetRadius() const
+{
+	return _radius;
+}
+
+void FieldOfView::SetOpaque(const Position& position, const bool& opaque)
+{
+	if (!Dark() or position.x < 0 or position.y < 0 or position.x >= _width or position.y >= _height)
+	{
+		return;
+	}
+
+	if (Test(_opaque, position.x, position.y) == opaque)
+	{
+		return;
+	}
+
+	_opaque[position.y * _rowWords + position.x / 64] ^= 1ULL << (position.x % 64);
+
+	if (_cast and std::abs(position.x - _eye.x) <= _radius and std::abs(position.y - _eye.y) <= _radius)
+	{
+		_dirty = true;
+	}
+}
+
+void FieldOfView::CastLight(const int& row, double start, const double& end, const int& xx, const int& xy, const int& yx, const int& yy)
+{
+	if (start < end)
+	{
+		return;
+	}
+
+	double newStart = 0.0;
+	bool blocked = false;
+	for (int distance = row; distance <= _radius and !blocked; distance++)
+	{
+		int dy = -distance;
+		for (int dx = -distance; dx <= 0; dx++)
+		{
+			//slopes of the cell's corners as seen from the eye
+			double leftSlope = (dx - 0.5) / (dy + 0.5);
+			double rightSlope = (dx + 0.5) / (dy - 0.5);
+			if (start < rightSlope)
+			{
+				continue;
+			}
+			else if (end > leftSlope)
+			{
+				break;
+			}
+
+			int x = _eye.x + dx * xx + dy * xy;
+			int y = _eye.y + dx * yx + dy * yy;
+			if (x < 0 or y < 0 or x >= _width or y >= _height)
+			{
+				continue;
+			}
+
+			if (dx * dx + dy * dy <= _radius * _radius)
+			{
+				Set(_visible, x, y);
+			}
+
+			bool opaque = Test(_opaque, x, y);
+			if (blocked)
+			{
+				if (opaque)
+				{
+					newStart = rightSlope;
+					continue;
+				}
+
+				blocked = false;
+				start = newStart;
+			}
+			else if (opaque and distance < _radius)
+			{
+				//the rest of this octant behind the cell is cast row by row in a narrower cone
+				blocked = true;
+				CastLight(distance + 1, start, leftSlope, xx, xy, yx, yy);
+				newStart = rightSlope;
+			}
+		}
+	}
+}
+
+bool FieldOfView::Update(const Position& eye, std::vector<Position>& changedPositions)
+{
+	if (!Dark() or (_cast and !_dirty and eye == _eye))
+	{
+		return false;
+	}
+
+	//_previous keeps the current view, the older one left in it is cleared to cast the new view over
+	std::swap(_visible, _previous);
+	std::swap(_visibleBox, _previousBox);
+	ClearBox(_visible, _visibleBox);
+
+	_eye = eye;
+	_visibleBox = BoxAround(eye);
+	if (eye.x >= 0 and eye.y >= 0 and eye.x < _width and eye.y < _height)
+	{
+		static const int OCTANTS[4][8] =
+		{
+			{ 1, 0, 0, -1, -1, 0, 0, 1 },
+			{ 0, 1, -1, 0, 0, -1, 1, 0 },
+			{ 0, 1, 1, 0, 0, -1, -1, 0 },
+			{ 1, 0, 0, 1, -1, 0, 0, -1 },
+		};
+
+		Set(_visible, eye.x, eye.y);
+		for (int octant = 0; octant < 8; octant++)
+		{
+			CastLight(1, 1.0, 0.0, OCTANTS[0][octant], OCTANTS[1][octant], OCTANTS[2][octant], OCTANTS[3][octant]);
+		}
+	}
+
+	//only the words of both views can differ
+	Box both = _visibleBox;
+	if (_previousBox.top <= _previousBox.bottom and _previousBox.firstWord <= _previousBox.lastWord)
+	{
+		both.top = std::min(both.top, _previousBox.top);
+		both.bottom = std::max(both.bottom, _previousBox.bottom);
+		both.firstWord = std::min(both.firstWord, _previousBox.firstWord);
+		both.lastWord = std::max(both.lastWord, _previousBox.lastWord);
+	}
+
+	for (int y = both.top; y <= both.bottom; y++)
+	{
+		for (int word = both.firstWord; word <= both.lastWord; word++)
+		{
+			int index = y * _rowWords + word;
+			unsigned long long changed = _visible[index] ^ _previous[index];
+			_explored[index] |= _visible[index];
+			for (int bit = 0; changed != 0; bit++, changed >>= 1)
+			{
+				if (changed & 1)
+				{
+					changedPositions.push_back({ word * 64 + bit, y });
+				}
+			}
+		}
+	}
+
+	_cast = true;
+	_dirty = false;
+	_casts++;
+	return true;
+}
+
+bool FieldOfView::Visible(const Position& position) const
+{
+	if (!Dark())
+	{
+		return true;
+	}
+
+	if (position.x < 0 or position.y < 0 or position.x >= _width or position.y >= _height)
+	{
+		return false;
+	}
+
+	return Test(_visible, position.x, position.y);
+}
+
+bool FieldOfView::Explored(const Position& position) const
+{
+	if (!Dark())
+	{
+		return true;
+	}
+
+	if (position.x < 0 or position.y < 0 or position.x >= _width or position.y >= _height)
+	{
+		return false;
+	}
+
+	return Test(_explored, position.x, position.y);
+}
+
+long long FieldOfView::Casts() const
+{
+	return _casts;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include "Arena.h"
+#include "Position.h"
+
+// what the player sees in a dark room: recursive shadowcasting from the eye over 8 octants, opaque cells stop the light
+// visible, explored and opaque cells are bitsets of the room (row by row), the view is cast again only when the eye moved
+// or an opaque cell in its reach changed, and only cells whose visibility flipped are reported for drawing
+
+class FieldOfView
+{
+private:
+	typedef std::vector<unsigned long long, ArenaAllocator<unsigned long long, MEMORY_TAG::VIEW>> Bitset;
+
+	struct Box //rows and words of a bitset the view can have bits in
+	{
+		int top;
+		int bottom;
+		int firstWord;
+		int lastWord;
+	};
+
+	int _width;
+	int _height;
+	int _radius; //0 - the room is lit, everything is visible
+	int _rowWords; //words per row
+	Bitset _opaque;
+	Bitset _visible;
+	Bitset _previous; //visible cells before the last cast, bits of an older cast within _previousBox
+	Bitset _explored;
+	Box _visibleBox;
+	Box _previousBox;
+	Position _eye;
+	bool _cast; //the view was cast at least once
+	bool _dirty; //an opaque cell in reach of the eye changed
+	long long _casts;
+
+	bool Test(const Bitset& bits, const int& x, const int& y) const;
+	void Set(Bitset& bits, const int& x, const int& y);
+	Box BoxAround(const Position& eye) const;
+	void ClearBox(Bitset& bits, const Box& box);
+	void CastLight(const int& row, double start, const double& end, const int& xx, const int& xy, const int& yx, const int& yy); //one octant, rows from row outwards between the start and end slopes
+
+public:
+	FieldOfView(const int& width = 0, const int& height = 0, const int& radius = 0);
+	bool Dark() const;
+	int GetRadius() const;
+	void SetOpaque(const Position& position, const bool& opaque); //marks the view for casting again if the cell is in reach of the eye
+	bool Update(const Position& eye, std::vector<Position>& changedPositions); //casts the view if needed, changedPositions gets the cells that appeared or disappeared, false if nothing was cast
+	bool Visible(const Position& position) const; //always true in a lit room
+	bool Explored(const Position& position) const; //was visible at some point since the room was loaded
+	long long Casts() const;
+};
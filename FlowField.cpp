@@ -0,0 +1,350 @@
+#include "FlowField.h"
+
+const int FlowField::WALL;
+const int FlowField::UNREACHED;
+
+FlowField::FlowField(const int& width, const int& height)
+{
+	_width = width;
+	_height = height;
+	_stride = width + 2;
+	if (width > 0 and height > 0)
+	{
+		_stored.assign(_stride * (height + 2), WALL);
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				_stored[Index({ x, y })] = UNREACHED;
+			}
+		}
+	}
+
+	_target = { -1, -1 };
+	_offset = 0;
+	_dirty = true;
+	_rebuilds = 0;
+}
+
+int FlowField::Index(const Position& position) const
+{
+	return (position.y + 1) * _stride + position.x + 1;
+}
+
+bool FlowField::Walkable(const Position& position) const
+{
+	return position.x >= 0 and position.y >= 0 and position.x < _width and position.y < _height and _stored[Index(position)] != WALL;
+}
+
+bool FlowField::Empty() const
+{
+	return _stored.empty();
+}
+
+void FlowField::SetWall(const Position& position, const bool& wall)
+{
+	if (Empty() or position.x < 0 or position.y < 0 or position.x >= _width or position.y >= _height)
+	{
+		return;
+	}
+
+	int cell = Index(position);
+	if ((_stored[cell] == WALL) == wall)
+	{
+		return;
+	}
+
+	if (_dirty or position == _target)
+	{
+		_stored[cell] = wall ? WALL : UNREACHED;
+		_dirty = true;
+		return;
+	}
+
+	if (wall)
+	{
+		Close(cell);
+	}
+	else
+	{
+		Open(cell);
+	}
+}
+
+int FlowField::Open(const int& cell)
+{
+	//distances only get shorter: the opened cell is one further than its closest neighbour, the cells it brings closer follow
+	const int neighbours[4] = { 1, -1, _stride, -_stride };
+	_stored[cell] = UNREACHED;
+	_queue.clear();
+	for (const int& neighbour : neighbours)
+	{
+		int stored = _stored[cell + neighbour];
+		if (stored != WALL and stored != UNREACHED and (_stored[cell] == UNREACHED or stored + 1 < _stored[cell]))
+		{
+			_stored[cell] = stored + 1;
+		}
+	}
+
+	if (_stored[cell] != UNREACHED)
+	{
+		_queue.push_back(cell);
+	}
+
+	Relax(0);
+	return static_cast<int>(_queue.size());
+}
+
+int FlowField::Close(const int& cell)
+{
+	//distances only get longer, and only for the cells whose every shortest way led through the closed cell: they are found
+	//layer by layer outwards, a cell is lost if no neighbour one closer kept its distance
+	const int neighbours[4] = { 1, -1, _stride, -_stride };
+	int closed = _stored[cell];
+	_stored[cell] = WALL;
+	if (closed == UNREACHED)
+	{
+		return 0;
+	}
+
+	_queue.clear();
+	_lost.clear();
+	for (const int& neighbour : neighbours)
+	{
+		if (_stored[cell + neighbour] == closed + 1)
+		{
+			_queue.push_back(cell + neighbour);
+		}
+	}
+
+	for (size_t head = 0; head < _queue.size(); head++)
+	{
+		int candidate = _queue[head];
+		int stored = _stored[candidate];
+		if (stored == UNREACHED)
+		{
+			continue; //lost through another neighbour already
+		}
+
+		bool kept = false;
+		for (const int& neighbour : neighbours)
+		{
+			kept = kept or _stored[candidate + neighbour] == stored - 1;
+		}
+
+		if (kept)
+		{
+			continue;
+		}
+
+		for (const int& neighbour : neighbours)
+		{
+			if (_stored[candidate + neighbour] == stored + 1)
+			{
+				_queue.push_back(candidate + neighbour);
+			}
+		}
+
+		_stored[candidate] = UNREACHED;
+		_lost.push_back(candidate);
+	}
+
+	//lost cells are searched again from the closest cells around them, nearest first
+	_seeds.clear();
+	for (const int& lost : _lost)
+	{
+		int best = UNREACHED;
+		for (const int& neighbour : neighbours)
+		{
+			int stored = _stored[lost + neighbour];
+			if (stored != WALL and stored != UNREACHED and (best == UNREACHED or stored + 1 < best))
+			{
+				best = stored + 1;
+			}
+		}
+
+		if (best != UNREACHED)
+		{
+			_seeds.push_back({ best, lost });
+		}
+	}
+
+	std::sort(_seeds.begin(), _seeds.end());
+	_queue.clear();
+	size_t head = 0;
+	for (const std::pair<int, int>& seed : _seeds)
+	{
+		int& stored = _stored[seed.second];
+		if (stored == UNREACHED or seed.first < stored)
+		{
+			//cells already queued one closer than this seed go first
+			head = Relax(head, seed.first - 1);
+			stored = seed.first;
+			_queue.push_back(seed.second);
+		}
+	}
+
+	Relax(head);
+	return static_cast<int>(_lost.size());
+}
+
+size_t FlowField::Relax(size_t head, const int& upTo)
+{
+	//queued cells pass their distance + 1 on to neighbours that are further or unreached, until one is further than upTo
+	const int neighbours[4] = { 1, -1, _stride, -_stride };
+	for (; head < _queue.size() and _stored[_queue[head]] <= upTo; head++)
+	{
+		int cell = _queue[head];
+		int distance = _stored[cell] + 1;
+		for (const int& neighbour : neighbours)
+		{
+			int& stored = _stored[cell + neighbour];
+			if (stored != WALL and (stored == UNREACHED or stored > distance))
+			{
+				stored = distance;
+				_queue.push_back(cell + neighbour);
+			}
+		}
+	}
+
+	return head;
+}
+
+int FlowField::Rebuild()
+{
+	for (int& stored : _stored)
+	{
+		if (stored != WALL)
+		{
+			stored = UNREACHED;
+		}
+	}
+
+	_offset = 0;
+	_dirty = false;
+	_rebuilds++;
+	if (!Walkable(_target))
+	{
+		return 0;
+	}
+
+	_queue.clear();
+	_queue.push_back(Index(_target));
+	_stored[_queue[0]] = 0;
+	Relax(0);
+	return static_cast<int>(_queue.size());
+}
+
+int FlowField::Step(const Position& target)
+{
+	//target was one cell further than its old neighbour, so are the cells that get closer than their old distance: each one
+	//is found from a neighbour that did, one cell further away, and gets 2 less stored (everything else gets 1 more with _offset)
+	const int neighbours[4] = { 1, -1, _stride, -_stride };
+	_queue.clear();
+	_queue.push_back(Index(target));
+	_stored[_queue[0]] -= 2;
+
+	for (size_t head = 0; head < _queue.size(); head++)
+	{
+		int cell = _queue[head];
+		int further = _stored[cell] + 3; //old stored distance of cells one further than this cell's old one
+		for (const int& neighbour : neighbours)
+		{
+			if (_stored[cell + neighbour] == further)
+			{
+				_stored[cell + neighbour] -= 2;
+				_queue.push_back(cell + neighbour);
+			}
+		}
+	}
+
+	_offset++;
+	_target = target;
+	return static_cast<int>(_queue.size());
+}
+
+int FlowField::Update(const Position& target)
+{
+	if (Empty() or (!_dirty and target == _target))
+	{
+		return 0;
+	}
+
+	int dx = target.x - _target.x;
+	int dy = target.y - _target.y;
+	if (_dirty or !Walkable(target) or _stored[Index(target)] == UNREACHED or std::abs(dx) > 1 or std::abs(dy) > 1)
+	{
+		_target = target;
+		return Rebuild();
+	}
+
+	if (dx == 0 or dy == 0)
+	{
+		return Step(target);
+	}
+
+	//a diagonal move is two steps through a free corner
+	Position corner = { target.x, _target.y };
+	if (!Walkable(corner))
+	{
+		corner = { _target.x, target.y };
+	}
+
+	if (!Walkable(corner))
+	{
+		_target = target;
+		return Rebuild();
+	}
+
+	int written = Step(corner);
+	return written + Step(target);
+}
+
+int FlowField::Distance(const Position& position) const
+{
+	if (Empty() or position.x < 0 or position.y < 0 or position.x >= _width or position.y >= _height)
+	{
+		return -1;
+	}
+
+	int stored = _stored[Index(position)];
+	return stored == WALL or stored == UNREACHED ? -1 : stored + _offset;
+}
+
+Position FlowField::NextStep(const Position& from) const
+{
+	if (Empty() or from.x < 0 or from.y < 0 or from.x >= _width or from.y >= _height)
+	{
+		return { 0,0 };
+	}
+
+	int cell = Index(from);
+	int stored = _stored[cell];
+	if (stored == WALL or stored == UNREACHED or stored + _offset == 0)
+	{
+		return { 0,0 };
+	}
+
+	//stored values of neighbours differ like distances, the border is never one closer
+	const Position directions[4] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+	const int neighbours[4] = { 1, -1, _stride, -_stride };
+	for (int i = 0; i < 4; i++)
+	{
+		if (_stored[cell + neighbours[i]] == stored - 1)
+		{
+			return directions[i];
+		}
+	}
+
+	return { 0,0 };
+}
+
+Position FlowField::GetTarget() const
+{
+	return _target;
+}
+
+long long FlowField::Rebuilds() const
+{
+	return _rebuilds;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <climits>
+#include <cstdlib>
+#include <algorithm>
+#include <utility>
+#include "Arena.h"
+#include "Position.h"
+
+// distance of every cell to one target (the player) by breadth-first search over non-collidable cells, 4 neighbours
+// one field serves any number of followers: a follower's next step is the neighbour one cell closer, read in O(1)
+// the grid is bipartite, so when the target steps to a neighbour every distance changes by exactly one: only the cells
+// that get closer (those whose shortest way led through the new target cell) are written, the rest move with _offset
+
+class FlowField
+{
+private:
+	static const int WALL = INT_MIN;
+	static const int UNREACHED = INT_MIN + 1;
+
+	int _width;
+	int _height;
+	int _stride; //a row with its border cells
+	std::vector<int, ArenaAllocator<int, MEMORY_TAG::FLOW>> _stored; //[(y + 1) * _stride + x + 1] - distance - _offset, WALL or UNREACHED, the border is WALL
+	std::vector<int, ArenaAllocator<int, MEMORY_TAG::FLOW>> _queue; //cells to pass their distance on, reused by every search
+	std::vector<int, ArenaAllocator<int, MEMORY_TAG::FLOW>> _lost; //cells that lost their way when a wall was added
+	std::vector<std::pair<int, int>, ArenaAllocator<std::pair<int, int>, MEMORY_TAG::FLOW>> _seeds; //distance and cell a lost cell is searched again from
+	Position _target;
+	int _offset;
+	bool _dirty; //nothing was searched yet or the target cell changed, searched in full on the next Update
+	long long _rebuilds;
+
+	int Index(const Position& position) const;
+	bool Walkable(const Position& position) const;
+	size_t Relax(size_t head, const int& upTo = INT_MAX); //passes distances on from _queue[head], returns where it stopped
+	int Rebuild(); //whole search from _target
+	int Step(const Position& target); //_target moves to the neighbouring target
+	int Open(const int& cell); //a wall became free, returns cells written
+	int Close(const int& cell); //a free cell became a wall, returns cells that lost their distance
+
+public:
+	FlowField(const int& width = 0, const int& height = 0);
+	bool Empty() const; //nothing to search over
+	void SetWall(const Position& position, const bool& wall); //repairs only the distances the wall changes
+	int Update(const Position& target); //follows the target, returns how many cells were written
+	int Distance(const Position& position) const; //steps to the target, -1 - walls, unreachable cells and outside
+	Position NextStep(const Position& from) const; //direction one cell closer to the target, { 0,0 } - there already or no way
+	Position GetTarget() const;
+	long long Rebuilds() const;
+};
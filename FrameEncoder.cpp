@@ -0,0 +1,264 @@
+#include "FrameEncoder.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRAME_ENCODER_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace
+{
+	const char RESET[] = "\u001b[0m";
+	const size_t RESET_LENGTH = sizeof(RESET) - 1;
+	const char CLEAR[] = "\u001b[0m\u001b[2J\u001b[H";
+	const size_t CHUNK = 16; //bytes copied at once, the buffer always has room for one chunk past the bytes written
+	const size_t CURSOR_LENGTH = 24; //"ESC[y;xH" with two signed 10 digit numbers at most
+
+#ifdef FRAME_ENCODER_SSE2
+	int LowestBit(const unsigned int& mask) //mask is not 0
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	//bit i set - cell i of the 16 at the pointers is the same as shown
+	unsigned int SameMask(const char* glyphs, const unsigned short* styles, const char* shownGlyphs, const unsigned short* shownStyles)
+	{
+		__m128i sameGlyphs = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(glyphs)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(shownGlyphs)));
+		__m128i sameLow = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(styles)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(shownStyles)));
+		__m128i sameHigh = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(styles + 8)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(shownStyles + 8)));
+		__m128i sameStyles = _mm_packs_epi16(sameLow, sameHigh); //0xffff and 0 stay -1 and 0 as bytes
+		return static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(sameGlyphs, sameStyles)));
+	}
+#endif
+}
+
+FrameEncoder::FrameEncoder(const size_t& capacity)
+{
+	_buffer.resize(capacity);
+	_size = 0;
+	_colorSlot = 0;
+}
+
+void FrameEncoder::Reserve(const size_t& bytes)
+{
+	if (_size + bytes > _buffer.size())
+	{
+		_buffer.resize(std::max(_buffer.size() * 2, _size + bytes));
+	}
+}
+
+void FrameEncoder::Append(const char* bytes, const size_t& length)
+{
+	std::memcpy(_buffer.data() + _size, bytes, length);
+	_size += length;
+}
+
+void FrameEncoder::AppendChunks(const char* bytes, const size_t& length)
+{
+#ifdef FRAME_ENCODER_SSE2
+	char* out = _buffer.data() + _size;
+	for (size_t i = 0; i < length; i += 16)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i)));
+	}
+
+	_size += length;
+#else
+	Append(bytes, length);
+#endif
+}
+
+void FrameEncoder::AppendNumber(int number)
+{
+	if (number < 0)
+	{
+		_buffer[_size++] = '-';
+		number = -number;
+	}
+
+	char digits[10];
+	int count = 0;
+	do
+	{
+		digits[count++] = static_cast<char>('0' + number % 10);
+		number /= 10;
+	} while (number > 0);
+
+	while (count > 0)
+	{
+		_buffer[_size++] = digits[--count];
+	}
+}
+
+int FrameEncoder::UnchangedSpan(const char* glyphs, const unsigned short* styles, const char* shownGlyphs, const unsigned short* shownStyles, const int& count)
+{
+	int i = 0;
+#ifdef FRAME_ENCODER_SSE2
+	for (; i + 16 <= count; i += 16)
+	{
+		unsigned int same = SameMask(glyphs + i, styles + i, shownGlyphs + i, shownStyles + i);
+		if (same != 0xffff)
+		{
+			return i + LowestBit(~same);
+		}
+	}
+#endif
+	while (i < count and glyphs[i] == shownGlyphs[i] and styles[i] == shownStyles[i])
+	{
+		i++;
+	}
+
+	return i;
+}
+
+int FrameEncoder::ChangedSpan(const char* glyphs, const unsigned short* styles, const char* shownGlyphs, const unsigned short* shownStyles, const int& count)
+{
+	int i = 0;
+#ifdef FRAME_ENCODER_SSE2
+	for (; i + 16 <= count; i += 16)
+	{
+		unsigned int same = SameMask(glyphs + i, styles + i, shownGlyphs + i, shownStyles + i);
+		if (same != 0)
+		{
+			return i + LowestBit(same);
+		}
+	}
+#endif
+	while (i < count and (glyphs[i] != shownGlyphs[i] or styles[i] != shownStyles[i]))
+	{
+		i++;
+	}
+
+	return i;
+}
+
+int FrameEncoder::StyleRun(const unsigned short* styles, const int& count)
+{
+	int i = 0;
+#ifdef FRAME_ENCODER_SSE2
+	__m128i style = _mm_set1_epi16(static_cast<short>(styles[0]));
+	for (; i + 8 <= count; i += 8)
+	{
+		unsigned int same = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(styles + i)), style)));
+		if (same != 0xffff)
+		{
+			return i + LowestBit(~same) / 2;
+		}
+	}
+#endif
+	while (i < count and styles[i] == styles[0])
+	{
+		i++;
+	}
+
+	return i;
+}
+
+void FrameEncoder::Clear()
+{
+	_size = 0;
+}
+
+void FrameEncoder::Encode(const char* glyphs, const unsigned short* styles, const char* shownGlyphs, const unsigned short* shownStyles,
+	const int& width, const int& height, const std::vector<std::string>& styleTexts)
+{
+	//colors in slots of whole chunks, so they are copied a chunk at a time
+	size_t longestColor = 0;
+	for (const std::string& style : styleTexts)
+	{
+		longestColor = std::max(longestColor, RESET_LENGTH + style.size());
+	}
+
+	_colorSlot = (longestColor + CHUNK - 1) / CHUNK * CHUNK;
+	_colors.assign(_colorSlot * styleTexts.size(), 0);
+	_colorLengths.resize(styleTexts.size());
+	for (size_t i = 0; i < styleTexts.size(); i++)
+	{
+		std::memcpy(_colors.data() + i * _colorSlot, RESET, RESET_LENGTH);
+		std::memcpy(_colors.data() + i * _colorSlot + RESET_LENGTH, styleTexts[i].data(), styleTexts[i].size());
+		_colorLengths[i] = RESET_LENGTH + styleTexts[i].size();
+	}
+
+	size_t cells = static_cast<size_t>(width) * height;
+
+	for (int y = 0; y < height; y++)
+	{
+		int row = y * width;
+		int x = 0;
+		while (true)
+		{
+			x += UnchangedSpan(glyphs + row + x, styles + row + x, shownGlyphs + row + x, shownStyles + row + x, width - x);
+			if (x == width)
+			{
+				break;
+			}
+
+			int end = x + ChangedSpan(glyphs + row + x, styles + row + x, shownGlyphs + row + x, shownStyles + row + x, width - x);
+			MoveCursor({ x, y });
+			Reserve((end - x) * (longestColor + 1) + RESET_LENGTH + CHUNK); //a span never needs more than a color change for every cell
+
+			//colors repeated only where they change, reset after the span
+			while (x < end)
+			{
+				int run = StyleRun(styles + row + x, end - x);
+				unsigned short style = styles[row + x];
+				AppendChunks(_colors.data() + style * _colorSlot, _colorLengths[style]);
+
+				//the chunk past the run is written over by what follows
+				if (static_cast<size_t>(row + x) + (run + CHUNK - 1) / CHUNK * CHUNK <= cells)
+				{
+					AppendChunks(glyphs + row + x, run);
+				}
+				else
+				{
+					Append(glyphs + row + x, run);
+				}
+
+				x += run;
+			}
+
+			Append(RESET, RESET_LENGTH);
+		}
+	}
+}
+
+void FrameEncoder::ClearScreen()
+{
+	Reserve(sizeof(CLEAR) - 1);
+	Append(CLEAR, sizeof(CLEAR) - 1);
+}
+
+void FrameEncoder::MoveCursor(const Position& position)
+{
+	//terminal rows and columns start at 1
+	Reserve(CURSOR_LENGTH);
+	_buffer[_size++] = '\u001b';
+	_buffer[_size++] = '[';
+	AppendNumber(position.y + 1);
+	_buffer[_size++] = ';';
+	AppendNumber(position.x + 1);
+	_buffer[_size++] = 'H';
+}
+
+const char* FrameEncoder::Data() const
+{
+	return _buffer.data();
+}
+
+size_t FrameEncoder::Size() const
+{
+	return _size;
+}
+
+size_t FrameEncoder::Capacity() const
+{
+	return _buffer.size();
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include "Position.h"
+
+// turns a frame of cells into the escape sequence bytes that draw it, straight into one buffer kept between frames
+// cells are two arrays row by row - glyphs and style indices - so unchanged spans and runs of one style are found 16 glyphs
+// and 8 styles at a time (SSE2 where the compiler has it), the bytes are the same as cursor moves and colors written one by one
+
+class FrameEncoder
+{
+private:
+	std::vector<char> _buffer; //grows, never shrinks - its size is the capacity
+	size_t _size; //bytes of the current frame
+	std::vector<char> _colors; //reset and style text of every style in slots of _colorSlot bytes, written where the style changes
+	std::vector<size_t> _colorLengths;
+	size_t _colorSlot;
+
+	void Reserve(const size_t& bytes); //room for bytes more
+	void Append(const char* bytes, const size_t& length);
+	void AppendChunks(const char* bytes, const size_t& length); //whole chunks - bytes must be readable up to the end of the last chunk
+	void AppendNumber(int number);
+
+	//lengths of the leading cells that are the same as shown, differ from shown and have the style of the first one
+	static int UnchangedSpan(const char* glyphs, const unsigned short* styles, const char* shownGlyphs, const unsigned short* shownStyles, const int& count);
+	static int ChangedSpan(const char* glyphs, const unsigned short* styles, const char* shownGlyphs, const unsigned short* shownStyles, const int& count);
+	static int StyleRun(const unsigned short* styles, const int& count);
+
+public:
+	FrameEncoder(const size_t& capacity = 1 << 16);
+	void Clear(); //starts the next frame, keeps the buffer
+	void Encode(const char* glyphs, const unsigned short* styles, const char* shownGlyphs, const unsigned short* shownStyles,
+		const int& width, const int& height, const std::vector<std::string>& styleTexts); //runs of cells that differ from shown
+	void ClearScreen(); //appends a terminal clear
+	void MoveCursor(const Position& position); //appends a cursor move
+	const char* Data() const;
+	size_t Size() const;
+	size_t Capacity() const;
+};
@@ -0,0 +1,78 @@
+#include "FramePacer.h"
+
+FramePacer::FramePacer(const float& frameRate, const double& outputShare, const int& maxInterval)
+{
+	_tickSeconds = 1.0 / frameRate;
+	_outputShare = outputShare;
+	_maxInterval = maxInterval;
+	_renderInterval = 1;
+	_ticksSinceRender = 0;
+	_rendering = false;
+	_averageWriteSeconds = 0.0;
+	_lastBytes = 0;
+	_lastNanoseconds = 0;
+	_skippedFrames = 0;
+}
+
+bool FramePacer::RenderDue()
+{
+	_ticksSinceRender++;
+	_rendering = _ticksSinceRender >= _renderInterval;
+
+	if (_rendering)
+	{
+		_ticksSinceRender = 0;
+	}
+	else
+	{
+		_skippedFrames++;
+	}
+
+	return _rendering;
+}
+
+bool FramePacer::HudAllowed() const
+{
+	return _averageWriteSeconds <= _tickSeconds * _outputShare;
+}
+
+void FramePacer::TickFinished(const Screen& screen)
+{
+	long long bytes = screen.BytesWritten() - _lastBytes;
+	long long nanoseconds = screen.WriteNanoseconds() - _lastNanoseconds;
+	_lastBytes = screen.BytesWritten();
+	_lastNanoseconds = screen.WriteNanoseconds();
+
+	if (!_rendering)
+	{
+		return;
+	}
+
+	_frameBytes.Add(bytes);
+	_frameLatency.Add(nanoseconds);
+	_averageWriteSeconds = 0.8 * _averageWriteSeconds + 0.2 * (nanoseconds / 1e9);
+
+	//a frame may take as long to write as the ticks until the next one allow, half of that to come back
+	double frameBudget = _renderInterval * _tickSeconds * _outputShare;
+	if (_averageWriteSeconds > frameBudget and _renderInterval < _maxInterval)
+	{
+		_renderInterval++;
+	}
+	else if (_renderInterval > 1 and _averageWriteSeconds < (_renderInterval - 1) * _tickSeconds * _outputShare * 0.5)
+	{
+		_renderInterval--;
+	}
+}
+
+int FramePacer::RenderInterval() const
+{
+	return _renderInterval;
+}
+
+void FramePacer::Report(std::ostream& reportStream) const
+{
+	reportStream << std::fixed << std::setprecision(2);
+	reportStream << "frames: " << _frameBytes.Count() << " presented, " << _skippedFrames << " skipped, render interval " << _renderInterval << " ticks\n";
+	reportStream << "frame bytes: mean " << _frameBytes.Mean() << ", p99 " << _frameBytes.Percentile(99) << ", max " << _frameBytes.Max() << "\n";
+	reportStream << "frame write time [us]: mean " << _frameLatency.Mean() / 1000.0 << ", p99 " << _frameLatency.Percentile(99) / 1000.0 << ", max " << _frameLatency.Max() / 1000.0 << "\n";
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <iostream>
+#include <iomanip>
+#include "Screen.h"
+#include "LatencyHistogram.h"
+
+// keeps terminal output within a share of the frame time: the simulation ticks at full rate,
+// over budget the HUD is left for later and then only every n-th tick is presented
+
+class FramePacer
+{
+private:
+	double _tickSeconds;
+	double _outputShare; //part of a tick the terminal may spend writing
+	int _maxInterval;
+	int _renderInterval; //ticks per presented frame
+	int _ticksSinceRender;
+	bool _rendering; //current tick presents a frame
+	double _averageWriteSeconds; //write time of a presented frame, moving average
+	long long _lastBytes;
+	long long _lastNanoseconds;
+	LatencyHistogram _frameBytes; //bytes of every presented frame
+	LatencyHistogram _frameLatency; //write time of every presented frame
+	long long _skippedFrames;
+
+public:
+	FramePacer(const float& frameRate, const double& outputShare = 0.5, const int& maxInterval = 8);
+	bool RenderDue(); //called once per tick, true if the tick presents a frame
+	bool HudAllowed() const; //false while output is over budget
+	void TickFinished(const Screen& screen); //measures the tick's output and adapts the render interval
+	int RenderInterval() const;
+	void Report(std::ostream& reportStream) const;
+};
@@ -1,16 +1,61 @@
 #include "Game.h"
 
-Game::Game(const std::vector<std::string>& filenames, const float& frameRate)
+const int Game::MENU_WAIT_MILLISECONDS;
+
+Game::Game(const std::vector<std::string>& filenames, const float& frameRate, const int& maxFallSpeed, const int& broadcastPort, const std::string& broadcastAddress)
 {
 	_levels = filenames;
 	_frameRate = frameRate;
+	_maxFallSpeed = maxFallSpeed;
+	_timer = new Timer();
+	_highscores = new HighscoreStore("highscores.journal");
+	if (broadcastPort != 0)
+	{
+		_broadcast = new BroadcastServer(broadcastPort, 256 * 1024, 3, broadcastAddress);
+	}
+	_screen = new ThreadedScreen(new ConsoleScreen(), _broadcast);
+	_input = new ConsoleInput();
+	_mapWatcher = new MapWatcher();
+	_pacer = new FramePacer(_frameRate);
+	_rewind = new RewindBuffer(static_cast<int>(60 * _frameRate));
+	_hudOutdated = false;
+	_memoryOverlay = false;
+	_overlayCountdown = 0;
+	_stopRequested = false;
+	_liveRoomInterval = 0;
+	_currentLevelIndex = 0;
+	_state = GAME_STATE::SELECTION;
+}
+
+Game::Game(const std::vector<std::string>& filenames, Screen* screen, Input* input, MapLibrary* mapLibrary, const int& maxFallSpeed)
+{
+	_levels = filenames;
+	_frameRate = 30;
+	_maxFallSpeed = maxFallSpeed;
 	_timer = new Timer();
+	_screen = screen;
+	_input = input;
+	_mapLibrary = mapLibrary;
+	_hudOutdated = false;
+	_memoryOverlay = false;
+	_overlayCountdown = 0;
+	_stopRequested = false;
+	_liveRoomInterval = 0;
+	_currentLevelIndex = 0;
+	_state = GAME_STATE::SELECTION;
 }
 
 Game::~Game()
 {
 	delete _currentLevel;
 	delete _timer;
+	delete _highscores;
+	delete _screen; //stops the render thread before the broadcast it writes to
+	delete _broadcast;
+	delete _input;
+	delete _mapWatcher;
+	delete _pacer;
+	delete _rewind;
 }
 
 void Game::LoadLevel(const int& levelIndex)
@@ -26,7 +71,21 @@ void Game::LoadLevel(const int& levelIndex)
 
 	if (levelStream.good())
 	{
-		_currentLevel = new Level(levelStream);
+		Level* level = new Level(levelStream, _screen, _mapLibrary);
+		delete _currentLevel;
+		_currentLevel = level;
+
+		if (_liveRoomInterval > 0)
+		{
+			_currentLevel->KeepRoomsLive(_liveRoomInterval);
+		}
+
+		//highscore line of the .level file is only the default until a score is saved in the journal
+		if (_highscores != nullptr)
+		{
+			_currentLevel->SetHighscore(_highscores->Get(HighscoreStore::Key(_levels[_currentLevelIndex]), _currentLevel->GetHighscore()));
+		}
+
 		_jumpingMaxFrame = _currentLevel->GetPlayer()->GetJumpHeight();
 	}
 	else
@@ -37,7 +96,7 @@ void Game::LoadLevel(const int& levelIndex)
 	levelStream.close();
 }
 
-bool Game::SelectionScreen()
+GAME_STATE Game::SelectionScreen()
 {
 	int selection = 0; // selection: 0=start; 1=change leve; 2=exit
 	int optionsNumber = 4;
@@ -68,61 +127,61 @@ bool Game::SelectionScreen()
 
 	while (true)
 	{
-		_timer->Tick();
-		if (_timer->DeltaTime() >= 1.0f / _frameRate)
+		//sleeps until a key changes, an idle menu costs no CPU time
+		_input->WaitForKey(MENU_WAIT_MILLISECONDS);
+		_input->Poll();
+
+		// up arrow
+		if (_input->KeyPressed(KEY::UP))
+		{
+			keyPressed = true;
+			selection = ((selection - 1) % optionsNumber) < 0 ? optionsNumber - 1 : selection - 1;
+			printSelectionScreen();
+		}
+
+		// down arrow
+		else if (_input->KeyPressed(KEY::DOWN))
+		{
+			keyPressed = true;
+			selection = (selection + 1) % optionsNumber;
+			printSelectionScreen();
+		}
+
+		// enter
+		else if (_input->KeyPressed(KEY::ENTER))
 		{
-			// up arrow
-			if (GetAsyncKeyState(VK_UP) and 0x26)
+			Sound::Play(Sound::GetSoundFilename(SOUND::SELECT));
+			keyPressed = true;
+			switch (selection)
 			{
-				keyPressed = true;
-				selection = ((selection - 1) % optionsNumber) < 0 ? optionsNumber - 1 : selection - 1;
+			case 0:
+				_currentLevelIndex = levelIndex;
+				return GAME_STATE::PLAYING;
+
+			case 1:
+				levelIndex = (levelIndex + 1) % _levels.size();
 				printSelectionScreen();
-			}
+				break;
 
-			// down arrow
-			else if (GetAsyncKeyState(VK_DOWN) and 0x28)
-			{
-				keyPressed = true;
-				selection = (selection + 1) % optionsNumber;
+			case 2:
+				HowToPlayScreen();
 				printSelectionScreen();
-			}
+				break;
 
-			// enter
-			else if (GetAsyncKeyState(VK_RETURN) and 0x0D)
-			{
-				Sound::Play(Sound::GetSoundFilename(SOUND::SELECT));
-				keyPressed = true;
-				switch (selection)
-				{
-				case 0:
-					LoadLevel(levelIndex);
-					return true;
-
-				case 1:
-					levelIndex = (levelIndex + 1) % _levels.size();
-					printSelectionScreen();
-					break;
-
-				case 2:
-					HowToPlayScreen();
-					printSelectionScreen();
-					break;
-
-				case 3:
-					return false;
-				}
+			case 3:
+				return GAME_STATE::EXIT;
 			}
+		}
 
-			if (keyPressed)
-			{
-				Sound::Play(Sound::GetSoundFilename(SOUND::SELECT));
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
-				keyPressed = false;
-			}
+		if (keyPressed)
+		{
+			Sound::Play(Sound::GetSoundFilename(SOUND::SELECT));
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			keyPressed = false;
 		}
 	}
 
-	return false;
+	return GAME_STATE::EXIT;
 }
 
 bool Game::MovePossible(std::vector<Position>& positions, const Position& direction)
@@ -137,86 +196,190 @@ bool Game::MovePossible(std::vector<Position>& positions, const Position& direct
 
 void Game::CheckOptions()
 {
-	for (EntityTile& tile : _currentLevel->GetOptionTiles())
+	//touched cells column by column, like the map stores them - a room switch skips the cells after it
+	_touchedPositions.assign(_currentLevel->GetPlayer()->GetCollidingPositions().begin(), _currentLevel->GetPlayer()->GetCollidingPositions().end());
+	std::sort(_touchedPositions.begin(), _touchedPositions.end(), [](const Position& a, const Position& b) { return a.x != b.x ? a.x < b.x : a.y < b.y; });
+
+	for (const Position& position : _touchedPositions)
 	{
-		if (_currentLevel->GetPlayer()->CollidingWith(tile))
-		{
-			Option option;
+		int first;
+		int number;
+		_currentLevel->GetMap()->TriggersAt(position, first, number);
 
-			option = tile.GetOption(OPTION::SWITCH_MAP);
-			if (option.Good())
+		for (int i = first; i < first + number; i++)
+		{
+			const Trigger& trigger = _currentLevel->GetMap()->GetTrigger(i);
+			if (trigger.enabled and !RunTrigger(trigger, position))
 			{
-				Position newPlayerPosition = Position({ option.arguments[1], option.arguments[2] });
-				int newMapIndex = option.arguments[0];
-				_currentLevel->LoadMap(newMapIndex);
-				_currentLevel->GetPlayer()->SetPosition(newPlayerPosition);
-				Update({0,0});
-				_currentLevel->GetMap()->Show();
-				HUD();
+				return; //the remaining triggers belong to the previous room
 			}
+		}
+	}
+}
 
-			option = tile.GetOption(OPTION::DEAL_DMG);
-			if (option.Good())
+bool Game::RunTrigger(const Trigger& trigger, const Position& position)
+{
+	for (int i = trigger.firstOp; i < trigger.firstOp + trigger.opsNumber; i++)
+	{
+		const TriggerOp& op = _currentLevel->GetMap()->GetTriggerOp(i);
+
+		switch (op.op)
+		{
+		case TRIGGER_OP::PLAY_SOUND:
+			_effects.PlaySound(static_cast<SOUND>(op.operands[0]));
+			break;
+
+		case TRIGGER_OP::PLAY_SCORE_SOUND:
+			_effects.PlaySound(op.operands[0] >= 0 ? SOUND::ADD_SCORE_G : SOUND::ADD_SCORE_B);
+			break;
+
+		case TRIGGER_OP::LOSE_HP:
+			_currentLevel->GetPlayer()->LoseHp(op.operands[0]);
+			if (_currentLevel->GetPlayer()->Dead())
 			{
-				Sound::Play(Sound::GetSoundFilename(SOUND::DEAL_DMG));
-				_currentLevel->GetPlayer()->LoseHp(option.arguments[0]);
+				_currentLevel->End();
+			}
 
-				if (_currentLevel->GetPlayer()->Dead())
-				{
-					_currentLevel->End();
-				}
+			_effects.UpdateHud();
+			break;
 
-				HUD();
+		case TRIGGER_OP::ADD_SCORE:
+			_currentLevel->AddScore(op.operands[0]);
+			_effects.UpdateHud();
+			break;
+
+		case TRIGGER_OP::COLLECT:
+			_currentLevel->CollectScore(position, static_cast<char>(op.operands[0]), op.operands[1], op.operands[2]);
+			break;
+
+		case TRIGGER_OP::SWITCH_MAP:
+		{
+			//the op goes away with the room
+			Position newPlayerPosition = { op.operands[1], op.operands[2] };
+			_currentLevel->GetMap()->RestoreCells(_drawnBody); //a live room is shown again as it is kept, without the player in it
+			_currentLevel->EnterMap(op.operands[0]);
+
+			//the room's file may have been edited smaller than the switch expects
+			Position extent = _currentLevel->GetPlayer()->BottomRight() - _currentLevel->GetPlayer()->TopLeft();
+			if (!_currentLevel->GetMap()->InBoundings(newPlayerPosition) or !_currentLevel->GetMap()->InBoundings(newPlayerPosition + extent))
+			{
+				FitPlayer(*_currentLevel->GetMap(), newPlayerPosition);
 			}
 
-			option = tile.GetOption(OPTION::ADD_SCORE);
-			if (option.Good())
+			_currentLevel->GetPlayer()->SetPosition(newPlayerPosition);
+			_drawnBody = {}; //player is not on the new map yet
+			_effects.ShowRoom();
+			return false;
+		}
+
+		case TRIGGER_OP::END_LEVEL:
+			_currentLevel->End();
+			break;
+		}
+	}
+
+	return true;
+}
+
+void Game::HotReload()
+{
+	if (_mapWatcher == nullptr)
+	{
+		return;
+	}
+
+	for (const std::string& filename : _mapWatcher->ChangedFiles())
+	{
+		if (_mapLibrary != nullptr)
+		{
+			_mapLibrary->Forget(filename);
+		}
+
+		//other rooms are read again when they are entered, unless they are kept live - then they are patched where they are
+		std::vector<std::string> mapFilenames = _currentLevel->GetMapFilenames();
+		for (int i = 0; i < static_cast<int>(mapFilenames.size()) and _currentLevel->LiveRooms() > 0; i++)
+		{
+			if (i != _currentLevel->GetMapIndex() and mapFilenames[i] == filename)
 			{
-				int score = option.arguments[0];
-				if (score >= 0)
+				try
 				{
-					Sound::Play(Sound::GetSoundFilename(SOUND::ADD_SCORE_G));
-				} 
-				
-				else
+					_currentLevel->ReloadRoom(i);
+				}
+				catch (Exception* exception)
 				{
-					Sound::Play(Sound::GetSoundFilename(SOUND::ADD_SCORE_B));
+					delete exception; //file caught half way through saving - the next save is patched
 				}
+			}
+		}
 
-				_currentLevel->AddScore(score);
-				HUD();
+		if (_currentLevel->GetMapIndex() >= static_cast<int>(mapFilenames.size()) or filename != mapFilenames[_currentLevel->GetMapIndex()])
+		{
+			continue;
+		}
 
-				//change to different tile in original map & remove gold option
-				char newCharacter = static_cast<char>(option.arguments[1]);
-				int newTileColor = option.arguments[2];
-				int newBackgroundColor = option.arguments[3];
-				_currentLevel->GetMap()->SetCharacterAt(tile.GetPosition(), newCharacter);
-				_currentLevel->GetMap()->RemoveOptionAt(tile.GetPosition(), OPTION::ADD_SCORE);
-				_currentLevel->GetMap()->SetTileColorAt(tile.GetPosition(), newTileColor);
-				_currentLevel->GetMap()->SetTileBackgroundColorAt(tile.GetPosition(), newBackgroundColor);
+		try
+		{
+			std::ifstream mapStream(filename);
+			std::vector<Position> changedPositions;
 
-				_currentLevel->AssignOptionTiles();
+			if (!_currentLevel->GetMap()->Patch(mapStream, changedPositions))
+			{
+				//size changed - the whole room is read again, with the player where it fits into it; a room it fits nowhere is not taken
+				std::ifstream resizedStream(filename);
+				Map resized(resizedStream, nullptr);
+				Position position = _currentLevel->GetPlayer()->TopLeft();
+				if (!FitPlayer(resized, position))
+				{
+					continue;
+				}
+
+				_currentLevel->LoadMap(_currentLevel->GetMapIndex());
+				_currentLevel->GetPlayer()->SetPosition(position);
+				_drawnBody = {};
+				Redraw();
+				_currentLevel->GetMap()->Show();
+				HUD();
+				continue;
 			}
 
-			option = tile.GetOption(OPTION::EXIT_LEVEL);
-			if (option.Good())
+			//patched cells under the player were drawn over it
+			if (!changedPositions.empty() and _currentLevel->GetPlayer()->CollidingWith(changedPositions))
 			{
-				_currentLevel->End();
+				_drawnBody = {};
+				Redraw();
 			}
 		}
+		catch (Exception* exception)
+		{
+			//file caught half way through saving - the next save is patched
+			delete exception;
+		}
+	}
+}
+
+void Game::AdvanceTimers()
+{
+	std::vector<Position> changedPositions;
+	_currentLevel->GetMap()->AdvanceTimers(changedPositions);
+	_currentLevel->AdvanceRooms();
+
+	//toggled cells under the player were drawn over it
+	if (!changedPositions.empty() and _currentLevel->GetPlayer()->CollidingWith(changedPositions))
+	{
+		_drawnBody = {};
+		Redraw();
 	}
 }
 
 void Game::ApplyGravity()
 {
-	//check if a block below player {or any gravity-object} is collidable then move down if isn't
-	Position direction = { 0,1 };
-	_currentLevel->GetPlayer()->SetDirection(direction);
+	//check how far the player {or any gravity-object} is above the floor then move down if it isn't standing on it
 	std::vector<Position> playerPositions = _currentLevel->GetPlayer()->GetCollidingPositions();
+	int fallDistance = _currentLevel->GetMap()->FallDistance(playerPositions, _maxFallSpeed);
 
-	if (MovePossible(playerPositions, direction))
+	if (fallDistance > 0)
 	{
-		Update(direction);
+		Update({ 0, fallDistance });
 		if (!_playerJumping) //prevents jumping after started falling
 		{
 			_playerJumping = true;
@@ -230,44 +393,269 @@ void Game::ApplyGravity()
 	}
 }
 
+void Game::Tick()
+{
+	_input->Poll();
+
+	//rewind is checked before the movement keys, so holding up while rewinding neither starts a jump nor plays its sound
+	if (_rewind != nullptr and _input->KeyPressed(KEY::REWIND))
+	{
+		Rewind(1); //the level plays backwards while the key is held, stops at the oldest recorded tick
+	}
+	else
+	{
+		Position direction;
+		KeyboardInput(direction);
+
+		//every step checks collision from the position resolved so far, the screen only sees the sum since the last presented frame
+		AdvanceTimers();
+		Jump();
+		Move(direction);
+		CheckOptions();
+		ApplyGravity();
+		RecordRewind();
+	}
+
+	RunEffects();
+
+	if (_pacer == nullptr or _pacer->RenderDue())
+	{
+		Redraw();
+
+		if (_hudOutdated and (_pacer == nullptr or _pacer->HudAllowed()))
+		{
+			HUD();
+		}
+
+		if (_memoryOverlay and --_overlayCountdown <= 0)
+		{
+			MemoryOverlay();
+			_overlayCountdown = static_cast<int>(_frameRate);
+		}
+	}
+
+	_screen->Flush();
+	if (_pacer != nullptr)
+	{
+		_pacer->TickFinished(*_screen);
+	}
+}
+
+void Game::RunEffects()
+{
+	for (const SOUND& sound : _effects.Sounds())
+	{
+		Sound::Play(Sound::GetSoundFilename(sound));
+	}
+
+	if (_effects.HudOutdated())
+	{
+		_hudOutdated = true; //drawn with the next presented frame
+	}
+
+	//a room the player entered is drawn whole now, whether or not the tick presents a frame
+	if (_effects.RoomEntered())
+	{
+		Redraw();
+		_currentLevel->GetMap()->Show();
+		HUD();
+	}
+
+	_effects.Finish();
+}
+
+const EffectQueue& Game::GetEffects() const
+{
+	return _effects;
+}
+
+bool Game::FitPlayer(const Map& map, Position& topLeft) const
+{
+	Player* player = _currentLevel->GetPlayer();
+	Position origin = player->TopLeft();
+	Position extent = player->BottomRight() - origin;
+	std::vector<Position> offsets;
+	for (const EntityTile& tile : player->GetBody())
+	{
+		offsets.push_back(tile.GetPosition() - origin);
+	}
+
+	//moved in from where it was, else where the level starts it, else the first free place
+	Position inside = topLeft;
+	inside.x = inside.x > map.GetWidth() - 1 - extent.x ? map.GetWidth() - 1 - extent.x : inside.x;
+	inside.y = inside.y > map.GetHeight() - 1 - extent.y ? map.GetHeight() - 1 - extent.y : inside.y;
+	inside.x = inside.x < 0 ? 0 : inside.x;
+	inside.y = inside.y < 0 ? 0 : inside.y;
+
+	std::vector<Position> candidates = { inside, _currentLevel->GetSpawn() };
+	for (int y = 0; y < map.GetHeight(); y++)
+	{
+		for (int x = 0; x < map.GetWidth(); x++)
+		{
+			candidates.push_back({ x, y });
+		}
+	}
+
+	for (Position& candidate : candidates)
+	{
+		bool fits = true;
+		for (Position& offset : offsets)
+		{
+			if (map.CollidingWith(candidate + offset)) //also outside the map
+			{
+				fits = false;
+				break;
+			}
+		}
+
+		if (fits)
+		{
+			topLeft = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Game::RecordRewind()
+{
+	if (_rewind == nullptr)
+	{
+		return;
+	}
+
+	RewindState state;
+	state.mapIndex = _currentLevel->GetMapIndex();
+	state.position = _currentLevel->GetPlayer()->TopLeft();
+	state.hp = _currentLevel->GetPlayer()->Hp();
+	state.score = _currentLevel->GetScore();
+	state.jumping = _playerJumping;
+	state.jumpingFrame = _jumpingFrame;
+	state.ended = _currentLevel->Ended();
+	state.roomTicks = _currentLevel->GetMap()->GetTicks();
+
+	_rewind->Record(state, *_currentLevel->GetMap(), _currentLevel->GetMapLoads());
+}
+
+bool Game::Rewind(const int& ticks)
+{
+	RewindState state;
+	std::vector<MapEdit> edits;
+
+	if (_rewind == nullptr or !_rewind->Rewind(ticks, state, edits))
+	{
+		return false;
+	}
+
+	//a room is its file plus its edits - it is loaded again only if the edits have to be undone or it is another room
+	if (state.mapIndex != _currentLevel->GetMapIndex() or !_currentLevel->GetMap()->HasEdits(edits))
+	{
+		_currentLevel->GetMap()->RestoreCells(_drawnBody); //the room left may be kept live
+		_currentLevel->LoadMap(state.mapIndex);
+		for (const MapEdit& edit : edits)
+		{
+			_currentLevel->GetMap()->ApplyEdit(edit);
+		}
+
+		_drawnBody = {};
+		_currentLevel->GetMap()->Show();
+		_hudOutdated = true;
+	}
+
+	std::vector<Position> changedPositions;
+	_currentLevel->GetMap()->SetTicks(state.roomTicks, changedPositions);
+	if (_currentLevel->GetPlayer()->CollidingWith(changedPositions))
+	{
+		_drawnBody = {};
+	}
+
+	//a room whose file was edited since may be smaller than where the player was
+	Player* player = _currentLevel->GetPlayer();
+	Position position = state.position;
+	Position extent = player->BottomRight() - player->TopLeft();
+	if (!_currentLevel->GetMap()->InBoundings(position) or !_currentLevel->GetMap()->InBoundings(position + extent))
+	{
+		FitPlayer(*_currentLevel->GetMap(), position);
+	}
+
+	_displacement += position - player->TopLeft();
+	player->SetPosition(position);
+
+	if (player->Hp() != state.hp or _currentLevel->GetScore() != state.score)
+	{
+		player->SetHp(state.hp);
+		_currentLevel->SetScore(state.score);
+		_hudOutdated = true;
+	}
+
+	_playerJumping = state.jumping;
+	_jumpingFrame = state.jumpingFrame;
+
+	if (state.ended)
+	{
+		_currentLevel->End();
+	}
+	else
+	{
+		_currentLevel->Resume();
+	}
+
+	return true;
+}
+
 void Game::Update(const Position& direction)
 {
 	//set player direction
 	_currentLevel->GetPlayer()->SetDirection(direction);
-
-	std::vector<EntityTile> oldState = _currentLevel->GetPlayer()->GetBody();
 	_currentLevel->GetPlayer()->Update();
-	std::vector<EntityTile> newState = _currentLevel->GetPlayer()->GetBody();
+	_displacement += direction;
+}
+
+void Game::Redraw()
+{
+	Player* player = _currentLevel->GetPlayer();
+	std::vector<EntityTile> body = player->GetBody();
 
-	_currentLevel->GetMap()->UpdateMap(oldState, newState);
+	//a dark room is seen from the middle of the player's top row, the view follows the drawn player
+	_currentLevel->GetMap()->UpdateView({ (player->TopLeft().x + player->BottomRight().x) / 2, player->TopLeft().y });
+
+	if (_drawnBody.size() == body.size() and _displacement == Position{ 0,0 })
+	{
+		return;
+	}
+
+	_currentLevel->GetMap()->UpdateMap(_drawnBody, body);
+	_drawnBody = body;
+	_displacement = { 0,0 };
 }
 
 void Game::KeyboardInput(Position& direction)
 {
 	direction = { 0,0 };
 
-	if (GetAsyncKeyState(VK_UP) and 0x26)
+	if (_input->KeyPressed(KEY::UP))
 	{
 		//up arrow
 		if (!_playerJumping)
 		{
 			_playerJumping = true;
-			Sound::Play(Sound::GetSoundFilename(SOUND::JUMP));
+			_effects.PlaySound(SOUND::JUMP);
 		}
 	}
 
-	if (GetAsyncKeyState(VK_DOWN) and 0x28)
+	if (_input->KeyPressed(KEY::DOWN))
 	{
 		//down arrow
 	}
 
-	if (GetAsyncKeyState(VK_RIGHT) and 0x27)
+	if (_input->KeyPressed(KEY::RIGHT))
 	{
 		//right arrow
 		direction.x = 1;
 	}
 
-	if (GetAsyncKeyState(VK_LEFT) and 0x25)
+	if (_input->KeyPressed(KEY::LEFT))
 	{
 		//left arrow
 		direction.x = -1;
@@ -326,7 +714,7 @@ void Game::Move(const Position& direction)
 	}
 }
 
-void Game::LostScreen()
+GAME_STATE Game::LostScreen()
 {
 	int selection = 0; // selection: 0=restart; 1=quit
 	int optionsNumber = 3;
@@ -359,103 +747,107 @@ void Game::LostScreen()
 	printGameOverScreen();
 	while (!selected)
 	{
-		_timer->Tick();
-		if (_timer->DeltaTime() >= 1.0f / _frameRate)
+		//sleeps until a key changes, an idle menu costs no CPU time
+		_input->WaitForKey(MENU_WAIT_MILLISECONDS);
+		_input->Poll();
+
+		// up arrow
+		if (_input->KeyPressed(KEY::UP))
 		{
-			// up arrow
-			if (GetAsyncKeyState(VK_UP) and 0x26)
-			{
-				keyPressed = true;
-				selection = ((selection - 1) % optionsNumber) < 0 ? optionsNumber - 1 : selection - 1;
-				printGameOverScreen();
-			}
+			keyPressed = true;
+			selection = ((selection - 1) % optionsNumber) < 0 ? optionsNumber - 1 : selection - 1;
+			printGameOverScreen();
+		}
 
-			// down arrow
-			else if (GetAsyncKeyState(VK_DOWN) and 0x28)
-			{
-				keyPressed = true;
-				selection = (selection + 1) % optionsNumber;
-				printGameOverScreen();
-			}
+		// down arrow
+		else if (_input->KeyPressed(KEY::DOWN))
+		{
+			keyPressed = true;
+			selection = (selection + 1) % optionsNumber;
+			printGameOverScreen();
+		}
 
-			// enter
-			else if (GetAsyncKeyState(VK_RETURN) and 0x0D)
-			{
-				Sound::Play(Sound::GetSoundFilename(SOUND::SELECT));
-				selected = true;
-			}
+		// enter
+		else if (_input->KeyPressed(KEY::ENTER))
+		{
+			Sound::Play(Sound::GetSoundFilename(SOUND::SELECT));
+			selected = true;
+		}
 
-			if (keyPressed)
-			{
-				Sound::Play(Sound::GetSoundFilename(SOUND::SELECT));
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
-				keyPressed = false;
-			}
+		if (keyPressed)
+		{
+			Sound::Play(Sound::GetSoundFilename(SOUND::SELECT));
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			keyPressed = false;
 		}
 	}
 
 	if (selection == 0)
 	{
-		RestartLevel();
+		return GAME_STATE::PLAYING;
 	}
 	else if (selection == 1)
 	{
 		std::this_thread::sleep_for(std::chrono::milliseconds(100)); // to prevent accidental game start
-		Start();
-	}
-	else if (selection == 2)
-	{
-		return;
+		return GAME_STATE::SELECTION;
 	}
+
+	return GAME_STATE::EXIT;
 }
 
-void Game::GameLoop()
+GAME_STATE Game::GameLoop()
 {
-	while (!_currentLevel->Ended())
+	while (!_currentLevel->Ended() and !_stopRequested)
 	{
 		_timer->Tick();
 		
 		if (_timer->DeltaTime() >= 1.0f / _frameRate)
 		{
-			Position direction;
-			KeyboardInput(direction);
-			Jump();
-			Move(direction);
-			CheckOptions();
-			ApplyGravity();
+			HotReload();
+			Tick();
 			std::this_thread::sleep_for(std::chrono::milliseconds(35));
 		}
 	}
 
+	_screen->Sync(); //the screens after a level write to the console directly
+
+	if (_stopRequested)
+	{
+		return GAME_STATE::EXIT;
+	}
+
 	if (_currentLevel->GetPlayer()->Dead())
 	{
 		Sound::Play(Sound::GetSoundFilename(SOUND::LOSE));
-		LostScreen();
+		return GAME_STATE::LOST;
 	}
 	else
 	{
 		if (_currentLevel->GetScore() > _currentLevel->GetHighscore())
 		{
-			std::fstream levelStream;
-			levelStream.open(_levels[_currentLevelIndex], std::ios::in | std::ios::out);
-			if (levelStream.good())
-			{
-				_currentLevel->SetHighscore(levelStream);
-			}
-			
-			else
+			_currentLevel->SetHighscore(_currentLevel->GetScore());
+
+			if (_highscores != nullptr)
 			{
-				throw new Exception(1, "[LEVEL] (output) file open error");
+				_highscores->Set(HighscoreStore::Key(_levels[_currentLevelIndex]), _currentLevel->GetScore());
 			}
-			
-			levelStream.close();
 		}
 		
 		Sound::Play(Sound::GetSoundFilename(SOUND::WIN));
-		WonScreen();
+		return GAME_STATE::WON;
 	}
 }
 
+void Game::Stop()
+{
+	_stopRequested = true;
+}
+
+void Game::SetLiveRooms(const int& interval)
+{
+	_liveRoomInterval = interval;
+}
+
 void Game::HUD()
 {
 	std::string textColor = "\u001b[37m\u001b[40m"; //white text, black background
@@ -471,60 +863,182 @@ void Game::HUD()
 	int highscore = _currentLevel->GetHighscore();
 
 	//clear HUD
-	Map::GotoPosition({ 0, mapHeight + 1 });
-
+	std::string hud;
 	for (int i = 0; i < mapWidth + 2 * maxHp; i++)
 	{
-		std::cout << backgroundColor << ".";
+		hud += backgroundColor + ".";
 	}
 
-	//draw new HUD data
-	Map::GotoPosition({ 0, mapHeight + 1 });
+	_screen->GotoPosition({ 0, mapHeight + 1 });
+	_screen->Write(hud);
 
+	//draw new HUD data
 	//score
-	std::cout << textColor << "Score:" << backgroundColor << "." << scoreColor << score << backgroundColor << ".";
+	hud = textColor + "Score:" + backgroundColor + "." + scoreColor + std::to_string(score) + backgroundColor + ".";
 
 	//hearts
 	for (int i = 0; i < mapWidth - 2 * maxHp - 7 /* Hearts: - 7 chars */- 7 /* Score: - 7 chars */ - Digits(score) - 1 /* 1 minimum space char */; i++)
 	{
-		std::cout << backgroundColor << ".";
+		hud += backgroundColor + ".";
 	}
 
-	std::cout << textColor << "Hearts:"; //red color
+	hud += textColor + "Hearts:"; //red color
 	for (int i = 0; i < Hp; i++)
 	{
-		std::cout << backgroundColor << "." << heartsColor << "*";
+		hud += backgroundColor + "." + heartsColor + "*";
 	}
-	std::cout << textColor;
+	hud += textColor;
 	for (int i = 0; i < maxHp - Hp; i++)
 	{
-		std::cout << backgroundColor << "." << textColor << "_";
+		hud += backgroundColor + "." + textColor + "_";
 	}
 
 	//highscore
-	std::cout << textColor << "\n\nHighscore:" << scoreColor << ((score > highscore) ? score : highscore);
+	hud += textColor + "\n\nHighscore:" + scoreColor + std::to_string((score > highscore) ? score : highscore);
 
 	//level info
-	std::cout << textColor << "\n\nLevel: (" << _currentLevelIndex << ") [" << _levels[_currentLevelIndex] << "]";
+	hud += textColor + "\n\nLevel: (" + std::to_string(_currentLevelIndex) + ") [" + _levels[_currentLevelIndex] + "]";
+
+	_screen->GotoPosition({ 0, mapHeight + 1 });
+	_screen->Write(hud);
+	_hudOutdated = false;
 }
 
-void Game::RestartLevel()
+void Game::SetMemoryOverlay(const bool& shown)
+{
+	_memoryOverlay = shown;
+	_overlayCountdown = 0;
+}
+
+void Game::MemoryOverlay()
+{
+	std::string textColor = "\u001b[37m\u001b[40m"; //white text, black background
+
+	//below the HUD's level line
+	std::string overlay;
+	for (const std::string& line : MemoryStats::Lines())
+	{
+		overlay += textColor + line + "\n";
+	}
+
+	_screen->GotoPosition({ 0, _currentLevel->GetMap()->GetHeight() + 7 });
+	_screen->Write(overlay + /* reset colors */ "\u001b[0m");
+}
+
+void Game::StartLevel(const int& levelIndex)
 {
-	Update({ 0,0 });
-	LoadLevel(_currentLevelIndex);
+	LoadLevel(levelIndex);
+	_playerJumping = false;
+	_jumpingFrame = 0;
+	_drawnBody = {};
+	_displacement = { 0,0 };
+	Redraw();
 	_currentLevel->GetMap()->Show();
 	HUD();
-	GameLoop();
+	_overlayCountdown = 0;
+
+	if (_rewind != nullptr)
+	{
+		_rewind->Clear();
+		RecordRewind();
+	}
+
+	if (_mapWatcher != nullptr)
+	{
+		_mapWatcher->Watch(_currentLevel->GetMapFilenames());
+	}
+}
+
+void Game::RestartLevel()
+{
+	StartLevel(_currentLevelIndex);
+}
+
+Level* Game::GetLevel()
+{
+	return _currentLevel;
+}
+
+bool Game::Jumping() const
+{
+	return _playerJumping;
+}
+
+int Game::JumpingFrame() const
+{
+	return _jumpingFrame;
+}
+
+void Game::SetJumping(const bool& jumping, const int& jumpingFrame)
+{
+	_playerJumping = jumping;
+	_jumpingFrame = jumpingFrame;
+}
+
+void Game::SetRewindTicks(const int& ticks)
+{
+	delete _rewind;
+	_rewind = nullptr;
+
+	if (ticks > 0)
+	{
+		_rewind = new RewindBuffer(ticks);
+		if (_currentLevel != nullptr)
+		{
+			RecordRewind();
+		}
+	}
+}
+
+const RewindBuffer* Game::GetRewindBuffer() const
+{
+	return _rewind;
 }
 
 void Game::Start()
 {
-	if (!SelectionScreen()) // false if exit was selected;
+	_state = GAME_STATE::SELECTION;
+
+	//every screen returns the next state instead of calling it, so the stack stays flat no matter how many levels are played
+	while (_state != GAME_STATE::EXIT)
 	{
-		return;
+		switch (_state)
+		{
+		case GAME_STATE::SELECTION:
+			_state = SelectionScreen();
+			break;
+
+		case GAME_STATE::PLAYING:
+			RestartLevel();
+			_state = GameLoop();
+			break;
+
+		case GAME_STATE::LOST:
+			_state = LostScreen();
+			break;
+
+		case GAME_STATE::WON:
+			_state = WonScreen();
+			break;
+
+		default:
+			_state = GAME_STATE::EXIT;
+			break;
+		}
 	}
 
-	RestartLevel();
+	if (_pacer != nullptr)
+	{
+		_screen->Clear();
+		_screen->Sync();
+		_pacer->Report(std::cout);
+	}
+
+	if (_memoryOverlay)
+	{
+		_screen->Sync();
+		MemoryStats::Report(std::cout);
+	}
 }
 
 void Game::HowToPlayScreen()
@@ -544,6 +1058,7 @@ void Game::HowToPlayScreen()
 		std::cout << borderColor << "//" << backgroundColor << ".................................................." << borderColor << "//" << std::endl;
 		std::cout << borderColor << "//" << backgroundColor << "............" << textColor << "Use arrow buttons to navigate" << backgroundColor << "........." << borderColor << "//" << std::endl;
 		std::cout << borderColor << "//" << backgroundColor << "..................." << textColor << "around the map" << backgroundColor << "................." << borderColor << "//" << std::endl;
+		std::cout << borderColor << "//" << backgroundColor << "............." << textColor << "Hold backspace to rewind" << backgroundColor << "............." << borderColor << "//" << std::endl;
 		std::cout << borderColor << "//" << backgroundColor << ".................................................." << borderColor << "//" << std::endl;
 		std::cout << borderColor << "//" << backgroundColor << "............" << textColor << "There are some special blocks" << backgroundColor << "........." << borderColor << "//" << std::endl;
 		std::cout << borderColor << "//" << backgroundColor << "........." << textColor << "that may damage your, give you gold" << backgroundColor << "......" << borderColor << "//" << std::endl;
@@ -558,7 +1073,7 @@ void Game::HowToPlayScreen()
 	}
 }
 
-void Game::WonScreen()
+GAME_STATE Game::WonScreen()
 {
 	std::string backgroundColor = "\u001b[30m\u001b[40m"; // black background, black text
 	std::string textColor = "\u001b[37m\u001b[40m"; //white text, black background
@@ -596,7 +1111,7 @@ void Game::WonScreen()
 		std::this_thread::sleep_for(std::chrono::milliseconds(1000));
 	}
 
-	Start();
+	return GAME_STATE::SELECTION;
 }
 
 int Game::Digits(int number)
@@ -3,9 +3,22 @@
 #include <Windows.h>
 #include <thread>
 #include <chrono>
+#include <atomic>
 #include "Level.h"
 #include "Timer.h"
 #include "Sound.h"
+#include "HighscoreStore.h"
+#include "Screen.h"
+#include "ThreadedScreen.h"
+#include "Input.h"
+#include "MapLibrary.h"
+#include "MapWatcher.h"
+#include "FramePacer.h"
+#include "RewindBuffer.h"
+#include "MemoryStats.h"
+#include "EffectQueue.h"
+
+enum class GAME_STATE { SELECTION = 0, PLAYING = 1, LOST = 2, WON = 3, EXIT = 4 };
 
 class Game
 {
@@ -14,30 +27,74 @@ private:
 	Level* _currentLevel = nullptr;
 	int _currentLevelIndex;
 	Timer* _timer = nullptr;
+	HighscoreStore* _highscores = nullptr; //nullptr - highscores are not saved
+	Screen* _screen = nullptr;
+	Input* _input = nullptr;
+	MapLibrary* _mapLibrary = nullptr; //not owned
+	MapWatcher* _mapWatcher = nullptr; //nullptr - maps are not reloaded when edited
+	FramePacer* _pacer = nullptr; //nullptr - every tick is presented
+	RewindBuffer* _rewind = nullptr; //nullptr - ticks are not recorded, nothing to rewind
+	BroadcastServer* _broadcast = nullptr; //nullptr - nobody can watch
 	float _frameRate;
 	bool _playerJumping;
 	int _jumpingFrame;
 	int _jumpingMaxFrame;
+	int _maxFallSpeed; //cells the player can fall in one tick
+	GAME_STATE _state;
+	std::vector<EntityTile> _drawnBody; //player body as it is currently drawn on the map
+	Position _displacement; //sum of jump, move and gravity steps since the last presented frame
+	bool _hudOutdated; //score or hp changed since the HUD was drawn
+	std::vector<Position> _touchedPositions; //reused by CheckOptions
+	EffectQueue _effects; //sounds, HUD and room drawing the current tick asked for, done once at its end
+	bool _memoryOverlay; //memory by subsystem is shown under the HUD
+	int _overlayCountdown; //ticks until the overlay is drawn again
+	std::atomic<bool> _stopRequested; //GameLoop returns EXIT after the current tick
+	int _liveRoomInterval; //rooms of the levels loaded from now on stay live, the ones left advance every this many ticks (0 - rooms are loaded again when entered)
+
+	static const int MENU_WAIT_MILLISECONDS = 500; //menus look at the keys at least this often, also when no key event comes
+
+	void RecordRewind(); //adds the state at the end of the tick to _rewind
+	bool FitPlayer(const Map& map, Position& topLeft) const; //moves topLeft to where the player's body is inside map and hits nothing: in from topLeft, else the level's spawn, else the first free place; false - nowhere
+	void RunEffects(); //what the tick's triggers asked for, each thing once
+	void MemoryOverlay();
 
 public:
-	Game(const std::vector<std::string>& filenames, const float& frameRate=30);
+	Game(const std::vector<std::string>& filenames, const float& frameRate=30, const int& maxFallSpeed=1, const int& broadcastPort=0, const std::string& broadcastAddress="127.0.0.1"); //broadcastPort - spectators can watch on it (0 - no broadcast), from this machine only unless broadcastAddress is another one
+	Game(const std::vector<std::string>& filenames, Screen* screen, Input* input, MapLibrary* mapLibrary, const int& maxFallSpeed=1); //headless session, owns screen and input, saves no highscores
 	~Game();
 	void LoadLevel(const int& levelIndex);
-	void GameLoop();
-	void Update(const Position& direction);
-	void KeyboardInput(Position& direction);
+	GAME_STATE GameLoop(); //plays the current level until it ends, returns LOST or WON (EXIT after Stop)
+	void Stop(); //from another thread: ends GameLoop after the current tick
+	void SetLiveRooms(const int& interval); //every room of the next level stays as it was left and keeps running, the ones the player is not in every interval ticks on a worker (0 - off)
+	void Tick(); //one frame: resolves jump, move and gravity into one displacement (or rewinds one tick) and redraws once (unless the pacer skips it)
+	void Update(const Position& direction); //moves the player, the map is updated by Redraw
+	void Redraw(); //moves the drawn player from _drawnBody to its current body
+	void KeyboardInput(Position& direction); //reads the keys polled for the tick
 	bool MovePossible(std::vector<Position>& positions, const Position& direction);
-	void Start();
-	void CheckOptions();
+	void Start(); //top-level loop driving the screens until EXIT is selected
+	void CheckOptions(); //runs the triggers of the cells the player touches
+	bool RunTrigger(const Trigger& trigger, const Position& position); //false if it switched the room, sounds and drawing are left to the end of the tick
+	void AdvanceTimers(); //one tick of the room's timed tiles
+	void HotReload(); //patches the current room with edits of its map file, keeps the player where it is
 	void HUD();
-	bool SelectionScreen();
+	void SetMemoryOverlay(const bool& shown); //memory by subsystem under the HUD, drawn again once a second and reported when the game exits
+	GAME_STATE SelectionScreen();
 	void ApplyGravity();
 	void Jump();
 	void Move(const Position& direction);
-	void LostScreen();
+	GAME_STATE LostScreen();
+	void StartLevel(const int& levelIndex); //loads the level and draws it, GameLoop or Tick plays it
 	void RestartLevel();
+	Level* GetLevel();
+	bool Jumping() const;
+	int JumpingFrame() const;
+	void SetJumping(const bool& jumping, const int& jumpingFrame);
+	void SetRewindTicks(const int& ticks); //how many ticks Rewind can go back (0 - none), the interactive game keeps 60 seconds
+	bool Rewind(const int& ticks); //restores the state of ticks ago and forgets the ticks after it, false if not recorded that far
+	const RewindBuffer* GetRewindBuffer() const;
+	const EffectQueue& GetEffects() const;
 	void HowToPlayScreen();
-	void WonScreen();
+	GAME_STATE WonScreen();
 	int Digits(int number); //returns the length of number (necessary for displaying numbers [to make it look pretty])
 };
 
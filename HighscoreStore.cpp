@@ -0,0 +1,213 @@
+#include "HighscoreStore.h"
+
+HighscoreStore::HighscoreStore(const std::string& journalFilename, const int& compactionThreshold)
+{
+	_journalFilename = journalFilename;
+	_compactionThreshold = compactionThreshold;
+	_journalRecords = 0;
+	_stopping = false;
+
+	if (!Load())
+	{
+		//rewrite the journal before anything is appended after the torn record
+		if (Compact(_highscores))
+		{
+			_journalRecords = static_cast<int>(_highscores.size());
+		}
+	}
+
+	//leftover of a compaction interrupted before the rename, the journal itself is still complete
+	std::remove((_journalFilename + ".tmp").c_str());
+
+	_writer = std::thread(&HighscoreStore::WriterLoop, this);
+}
+
+HighscoreStore::~HighscoreStore()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+
+	_recordsPending.notify_one();
+	_writer.join();
+}
+
+bool HighscoreStore::Load()
+{
+	std::ifstream journalStream(_journalFilename);
+
+	if (!journalStream.good())
+	{
+		return true; //no highscores saved yet
+	}
+
+	std::string record;
+	while (std::getline(journalStream, record))
+	{
+		if (journalStream.eof())
+		{
+			journalStream.close();
+			return false; //last record has no line end - it was torn by a crash
+		}
+
+		size_t separator = record.rfind('\t');
+		if (separator == std::string::npos)
+		{
+			continue;
+		}
+
+		std::stringstream scoreData(record.substr(separator + 1));
+		int score;
+		if (!(scoreData >> score))
+		{
+			continue;
+		}
+
+		_highscores[record.substr(0, separator)] = score;
+		_journalRecords++;
+	}
+
+	journalStream.close();
+	return true;
+}
+
+void HighscoreStore::WriterLoop()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while (true)
+	{
+		_recordsPending.wait(lock, [this]() { return _stopping or !_pendingRecords.empty(); });
+
+		if (_pendingRecords.empty())
+		{
+			return; //stopping and everything is written
+		}
+
+		std::vector<std::pair<std::string, int>> records;
+		records.swap(_pendingRecords);
+
+		lock.unlock();
+		bool written = Append(records);
+		lock.lock();
+
+		if (!written)
+		{
+			//keep the records in order and try again later
+			_pendingRecords.insert(_pendingRecords.begin(), records.begin(), records.end());
+
+			if (_stopping)
+			{
+				return;
+			}
+
+			_recordsPending.wait_for(lock, std::chrono::seconds(1));
+			continue;
+		}
+
+		_journalRecords += static_cast<int>(records.size());
+
+		if (_journalRecords > _compactionThreshold)
+		{
+			//records set after this copy are appended again after the rename - duplicates are harmless
+			std::unordered_map<std::string, int> highscores = _highscores;
+
+			lock.unlock();
+			bool compacted = Compact(highscores);
+			lock.lock();
+
+			if (compacted)
+			{
+				_journalRecords = static_cast<int>(highscores.size());
+			}
+		}
+	}
+}
+
+bool HighscoreStore::Append(const std::vector<std::pair<std::string, int>>& records)
+{
+	std::string text;
+	for (const std::pair<std::string, int>& record : records)
+	{
+		text += record.first + '\t' + std::to_string(record.second) + '\n';
+	}
+
+	//on the disk before it counts as written, so a power loss keeps every record the game was told about
+	return WriteToDisk(_journalFilename, text, true);
+}
+
+bool HighscoreStore::Compact(const std::unordered_map<std::string, int>& highscores)
+{
+	std::string temporaryFilename = _journalFilename + ".tmp";
+	std::string text;
+
+	for (const std::pair<const std::string, int>& highscore : highscores)
+	{
+		text += highscore.first + '\t' + std::to_string(highscore.second) + '\n';
+	}
+
+	//the data has to reach the disk before the rename does, else a power loss can leave a renamed empty journal
+	if (!WriteToDisk(temporaryFilename, text, false))
+	{
+		std::remove(temporaryFilename.c_str());
+		return false;
+	}
+
+	//the old journal stays in place until the new one is complete
+	return MoveFileExA(temporaryFilename.c_str(), _journalFilename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+bool HighscoreStore::WriteToDisk(const std::string& filename, const std::string& text, const bool& append)
+{
+	HANDLE file = CreateFileA(filename.c_str(), append ? FILE_APPEND_DATA : GENERIC_WRITE, FILE_SHARE_READ, nullptr, append ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	size_t offset = 0;
+	bool written = true;
+	while (written and offset < text.size())
+	{
+		DWORD bytesWritten = 0;
+		written = WriteFile(file, text.data() + offset, static_cast<DWORD>(text.size() - offset), &bytesWritten, nullptr) != 0 and bytesWritten > 0;
+		offset += bytesWritten;
+	}
+
+	written = written and FlushFileBuffers(file) != 0;
+	CloseHandle(file);
+
+	return written;
+}
+
+bool HighscoreStore::Has(const std::string& key) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _highscores.find(key) != _highscores.end();
+}
+
+int HighscoreStore::Get(const std::string& key, const int& defaultScore) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::unordered_map<std::string, int>::const_iterator highscore = _highscores.find(key);
+
+	return (highscore != _highscores.end()) ? highscore->second : defaultScore;
+}
+
+void HighscoreStore::Set(const std::string& key, const int& score)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_highscores[key] = score;
+		_pendingRecords.push_back({ key, score });
+	}
+
+	_recordsPending.notify_one();
+}
+
+std::string HighscoreStore::Key(const std::string& levelFilename, const std::string& profile)
+{
+	return profile.empty() ? levelFilename : profile + ":" + levelFilename;
+}
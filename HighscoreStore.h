@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <Windows.h>
+#include "Exception.h"
+
+// highscores journal: one "key<TAB>score" record per line, later records win
+// records are only ever appended and flushed to the disk; the journal is compacted into a temporary file, flushed the same way, that replaces it in one rename
+
+class HighscoreStore
+{
+private:
+	std::string _journalFilename;
+	std::unordered_map<std::string, int> _highscores; //newest score for every key
+	std::vector<std::pair<std::string, int>> _pendingRecords; //set but not yet written by the writer thread
+	int _journalRecords; //records in the journal file (compaction starts when it gets over _compactionThreshold)
+	int _compactionThreshold;
+	bool _stopping;
+	mutable std::mutex _mutex;
+	std::condition_variable _recordsPending;
+	std::thread _writer;
+
+	bool Load(); //reads the journal, skips malformed records; false if the last record was torn by a crash
+	void WriterLoop(); //background thread: appends pending records and compacts the journal
+	bool Append(const std::vector<std::pair<std::string, int>>& records);
+	bool Compact(const std::unordered_map<std::string, int>& highscores);
+	static bool WriteToDisk(const std::string& filename, const std::string& text, const bool& append); //returns once the text is flushed to the disk, not only to the OS
+
+public:
+	HighscoreStore(const std::string& journalFilename, const int& compactionThreshold = 64);
+	~HighscoreStore(); //writes every pending record before returning
+	bool Has(const std::string& key) const;
+	int Get(const std::string& key, const int& defaultScore = 0) const;
+	void Set(const std::string& key, const int& score); //visible to Get at once, written to the journal in the background
+	static std::string Key(const std::string& levelFilename, const std::string& profile = ""); //key for a level (and player profile)
+};
@@ -0,0 +1,239 @@
+#include "Input.h"
+
+Input::~Input() {}
+
+void Input::Poll() {}
+
+bool Input::WaitForKey(const int& milliseconds)
+{
+	return true;
+}
+
+ConsoleInput::~ConsoleInput() {}
+
+bool ConsoleInput::KeyPressed(const KEY& key)
+{
+	return GetAsyncKeyState(VirtualKey(key)) != 0;
+}
+
+bool ConsoleInput::WaitForKey(const int& milliseconds)
+{
+	//keys are read with GetAsyncKeyState, the console's events only wake the wait and are dropped
+	HANDLE console = GetStdHandle(STD_INPUT_HANDLE);
+	bool woken = WaitForSingleObject(console, static_cast<DWORD>(milliseconds)) == WAIT_OBJECT_0;
+	FlushConsoleInputBuffer(console);
+	return woken;
+}
+
+int ConsoleInput::VirtualKey(const KEY& key)
+{
+	switch (key)
+	{
+	case KEY::UP:
+		return VK_UP;
+
+	case KEY::DOWN:
+		return VK_DOWN;
+
+	case KEY::LEFT:
+		return VK_LEFT;
+
+	case KEY::RIGHT:
+		return VK_RIGHT;
+
+	case KEY::ENTER:
+		return VK_RETURN;
+
+	case KEY::REWIND:
+		return VK_BACK;
+
+	default:
+		throw new Exception(2, "[INPUT] unknown key.");
+		break;
+	}
+}
+
+ScriptedInput::ScriptedInput(std::istream& scriptStream)
+{
+	std::string frameLine;
+	while (std::getline(scriptStream, frameLine))
+	{
+		int keys = 0;
+		for (const char& letter : frameLine)
+		{
+			switch (letter)
+			{
+			case 'U':
+				keys |= 1 << static_cast<int>(KEY::UP);
+				break;
+
+			case 'D':
+				keys |= 1 << static_cast<int>(KEY::DOWN);
+				break;
+
+			case 'L':
+				keys |= 1 << static_cast<int>(KEY::LEFT);
+				break;
+
+			case 'R':
+				keys |= 1 << static_cast<int>(KEY::RIGHT);
+				break;
+
+			case 'E':
+				keys |= 1 << static_cast<int>(KEY::ENTER);
+				break;
+
+			case 'B':
+				keys |= 1 << static_cast<int>(KEY::REWIND);
+				break;
+
+			case '\r':
+				break;
+
+			default:
+				throw new Exception(0, "[INPUT] invalid script key '" + std::string(1, letter) + "'.");
+				break;
+			}
+		}
+
+		_frames.push_back(keys);
+	}
+
+	if (_frames.empty())
+	{
+		throw new Exception(0, "[INPUT] empty input script.");
+	}
+
+	_currentFrame = -1;
+}
+
+ScriptedInput::~ScriptedInput() {}
+
+void ScriptedInput::Poll()
+{
+	_currentFrame = (_currentFrame + 1) % static_cast<int>(_frames.size());
+}
+
+bool ScriptedInput::KeyPressed(const KEY& key)
+{
+	return _currentFrame >= 0 and (_frames[_currentFrame] & (1 << static_cast<int>(key))) != 0;
+}
+
+int ScriptedInput::Length() const
+{
+	return static_cast<int>(_frames.size());
+}
+
+ManualInput::ManualInput()
+{
+	_keys = 0;
+	_polledKeys = 0;
+}
+
+ManualInput::~ManualInput() {}
+
+void ManualInput::SetKeys(const int& keys)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_keys = keys;
+	}
+
+	_keysChanged.notify_all();
+}
+
+void ManualInput::Poll()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_polledKeys = _keys;
+}
+
+bool ManualInput::KeyPressed(const KEY& key)
+{
+	return (_keys & (1 << static_cast<int>(key))) != 0;
+}
+
+bool ManualInput::WaitForKey(const int& milliseconds)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	return _keysChanged.wait_for(lock, std::chrono::milliseconds(milliseconds), [this]() { return _keys != _polledKeys; });
+}
+
+RandomInput::RandomInput(const unsigned int& seed, const int& holdFrames) : _generator(seed)
+{
+	_holdFrames = holdFrames;
+	_heldFrames = 0;
+	_keys = 0;
+}
+
+RandomInput::~RandomInput() {}
+
+void RandomInput::Poll()
+{
+	if (_heldFrames % _holdFrames == 0)
+	{
+		//up, left and right only - enter and down do nothing in a level
+		_keys = static_cast<int>(_generator() % 8);
+	}
+
+	_heldFrames++;
+}
+
+bool RandomInput::KeyPressed(const KEY& key)
+{
+	switch (key)
+	{
+	case KEY::UP:
+		return (_keys & 1) != 0;
+
+	case KEY::LEFT:
+		return (_keys & 2) != 0;
+
+	case KEY::RIGHT:
+		return (_keys & 4) != 0;
+
+	default:
+		return false;
+	}
+}
+
+ProbeInput::ProbeInput()
+{
+	_keys = 0;
+	_polledKeys = 0;
+	_injectedAt = 0;
+	_seenAt = 0;
+}
+
+ProbeInput::~ProbeInput() {}
+
+long long ProbeInput::Inject(const int& keys)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_keys = keys;
+	_injectedAt = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	_seenAt = 0;
+	return _injectedAt;
+}
+
+void ProbeInput::Poll()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_seenAt == 0 and _injectedAt != 0)
+	{
+		_seenAt = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	_polledKeys = _keys;
+}
+
+bool ProbeInput::KeyPressed(const KEY& key)
+{
+	return (_polledKeys & (1 << static_cast<int>(key))) != 0;
+}
+
+long long ProbeInput::SeenAt()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _seenAt;
+}
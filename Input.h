@@ -0,0 +1,97 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <random>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <Windows.h>
+#include "Exception.h"
+
+enum class KEY { UP = 0, DOWN = 1, LEFT = 2, RIGHT = 3, ENTER = 4, REWIND = 5 };
+
+// input backend used by the game loop and the screens
+
+class Input
+{
+public:
+	virtual ~Input();
+	virtual void Poll(); //called once per frame before keys are read
+	virtual bool KeyPressed(const KEY& key) = 0;
+	virtual bool WaitForKey(const int& milliseconds); //blocks until a key may have changed or the time is up, false - the time is up; inputs driven by frames return at once
+};
+
+class ConsoleInput : public Input
+{
+public:
+	virtual ~ConsoleInput();
+	bool KeyPressed(const KEY& key) override;
+	bool WaitForKey(const int& milliseconds) override; //sleeps on the console's input events
+	static int VirtualKey(const KEY& key);
+};
+
+class ScriptedInput : public Input //replays a script, one line per frame, repeated when it ends
+{
+private:
+	std::vector<int> _frames; //pressed keys of each frame as bits (1 << KEY)
+	int _currentFrame;
+
+public:
+	ScriptedInput(std::istream& scriptStream); //line letters: U - up, D - down, L - left, R - right, E - enter, B - rewind; empty line - nothing pressed
+	virtual ~ScriptedInput();
+	void Poll() override;
+	bool KeyPressed(const KEY& key) override;
+	int Length() const; //frames of the script
+};
+
+class ManualInput : public Input //keys set by the program (bits: 1 << KEY), from any thread
+{
+private:
+	std::atomic<int> _keys;
+	int _polledKeys; //keys at the last Poll, a change wakes WaitForKey
+	std::mutex _mutex;
+	std::condition_variable _keysChanged;
+
+public:
+	ManualInput();
+	virtual ~ManualInput();
+	void SetKeys(const int& keys);
+	void Poll() override;
+	bool KeyPressed(const KEY& key) override;
+	bool WaitForKey(const int& milliseconds) override;
+};
+
+class RandomInput : public Input //random key combinations, each one held for a few frames
+{
+private:
+	std::mt19937 _generator;
+	int _holdFrames;
+	int _heldFrames;
+	int _keys;
+
+public:
+	RandomInput(const unsigned int& seed, const int& holdFrames = 8);
+	virtual ~RandomInput();
+	void Poll() override;
+	bool KeyPressed(const KEY& key) override;
+};
+
+class ProbeInput : public Input //keys injected from another thread, for latency runs: remembers when they were injected and when a Poll first saw them (steady clock nanoseconds)
+{
+private:
+	int _keys;
+	int _polledKeys; //keys the frame reads
+	long long _injectedAt;
+	long long _seenAt; //0 - no Poll since the last injection
+	std::mutex _mutex;
+
+public:
+	ProbeInput();
+	virtual ~ProbeInput();
+	long long Inject(const int& keys); //returns when they were injected
+	void Poll() override;
+	bool KeyPressed(const KEY& key) override;
+	long long SeenAt();
+};
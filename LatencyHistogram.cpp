@@ -0,0 +1,109 @@
+#include "LatencyHistogram.h"
+
+LatencyHistogram::LatencyHistogram()
+{
+	Clear();
+}
+
+int LatencyHistogram::Bucket(const long long& nanoseconds)
+{
+	if (nanoseconds < 8)
+	{
+		return nanoseconds < 0 ? 0 : static_cast<int>(nanoseconds);
+	}
+
+	int exponent = 3;
+	while ((nanoseconds >> (exponent + 1)) != 0)
+	{
+		exponent++;
+	}
+
+	int subBucket = static_cast<int>((nanoseconds >> (exponent - 3)) & 7);
+	return (exponent - 2) * 8 + subBucket;
+}
+
+long long LatencyHistogram::BucketValue(const int& bucket)
+{
+	if (bucket < 8)
+	{
+		return bucket;
+	}
+
+	int exponent = bucket / 8 + 2;
+	long long lower = static_cast<long long>(8 + bucket % 8) << (exponent - 3);
+	return lower + (1LL << (exponent - 3)) - 1;
+}
+
+void LatencyHistogram::Add(const long long& nanoseconds)
+{
+	_buckets[Bucket(nanoseconds)]++;
+	_count++;
+	_sum += static_cast<double>(nanoseconds);
+
+	if (nanoseconds > _max)
+	{
+		_max = nanoseconds;
+	}
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& histogram)
+{
+	for (int i = 0; i < static_cast<int>(_buckets.size()); i++)
+	{
+		_buckets[i] += histogram._buckets[i];
+	}
+
+	_count += histogram._count;
+	_sum += histogram._sum;
+
+	if (histogram._max > _max)
+	{
+		_max = histogram._max;
+	}
+}
+
+void LatencyHistogram::Clear()
+{
+	_buckets = std::vector<long long>(64 * 8, 0);
+	_count = 0;
+	_max = 0;
+	_sum = 0.0;
+}
+
+long long LatencyHistogram::Count() const
+{
+	return _count;
+}
+
+long long LatencyHistogram::Max() const
+{
+	return _max;
+}
+
+double LatencyHistogram::Mean() const
+{
+	return _count > 0 ? _sum / static_cast<double>(_count) : 0.0;
+}
+
+long long LatencyHistogram::Percentile(const double& percentile) const
+{
+	if (_count == 0)
+	{
+		return 0;
+	}
+
+	long long rank = static_cast<long long>(percentile / 100.0 * static_cast<double>(_count - 1)) + 1;
+	long long seen = 0;
+
+	for (int i = 0; i < static_cast<int>(_buckets.size()); i++)
+	{
+		seen += _buckets[i];
+		if (seen >= rank)
+		{
+			//the bucket bound can be above everything that was really added
+			return BucketValue(i) < _max ? BucketValue(i) : _max;
+		}
+	}
+
+	return _max;
+}
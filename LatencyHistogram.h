@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+
+// log-linear histogram of durations in nanoseconds: 8 buckets per power of two (values within 12.5%)
+
+class LatencyHistogram
+{
+private:
+	std::vector<long long> _buckets;
+	long long _count;
+	long long _max;
+	double _sum;
+
+	static int Bucket(const long long& nanoseconds);
+	static long long BucketValue(const int& bucket); //largest value that falls into bucket
+
+public:
+	LatencyHistogram();
+	void Add(const long long& nanoseconds);
+	void Merge(const LatencyHistogram& histogram);
+	void Clear();
+	long long Count() const;
+	long long Max() const;
+	double Mean() const;
+	long long Percentile(const double& percentile) const; //percentile in 0-100, 0 if nothing was added
+};
@@ -1,35 +1,68 @@
 #include "Level.h"
 
-Level::Level(std::istream& levelStream)
+const int Level::CHUNKS_AHEAD;
+const int Level::CHUNK_THREADS;
+
+Level::Level(std::istream& levelStream, Screen* screen, MapLibrary* mapLibrary)
 {
-	Load(levelStream);
+	_screen = screen;
+	_mapLibrary = mapLibrary;
+	_arena.reset(new Arena());
+	_mapLoads = 0;
+	_currentMapIndex = 0;
+	_roomInterval = 0;
+	_ticks = 0;
+	_roomBatches = 0;
+	_roomSteps = 0;
+	_roomNanoseconds = 0;
+
+	{
+		ArenaScope scope(_arena.get());
+		Load(levelStream);
+	}
+
 	LoadMap(0);
 	_score = 0;
 	_ended = false;
 }
 
-Level::~Level()
-{
-	delete _map;
-	delete _player;
-}
+Level::~Level() {} //arenas release the map and the player
 
 void Level::Load(std::istream& levelStream)
 {
-	// maps number
+	// maps number (or endless seed width height)
 	// map path
 	// player
 
 	std::string mapsNumberLine;
 	std::getline(levelStream, mapsNumberLine);
-	int mapsNumber = std::stoi(mapsNumberLine);
-	//check if correct map data
 
-	for (int i = 0; i < mapsNumber; i++)
+	if (mapsNumberLine.compare(0, 7, "endless") == 0)
 	{
-		std::string mapPath;
-		std::getline(levelStream, mapPath);
-		_maps.push_back(mapPath);
+		std::stringstream endlessData(mapsNumberLine.substr(7));
+		int seed;
+		int width;
+		int height;
+		if (!(endlessData >> seed >> width >> height))
+		{
+			throw new Exception(0, "[LEVEL] (5) invalid file input - not enough endless level data.");
+		}
+
+		//workers and the chunks they share are not the level's to release
+		ArenaScope scope(nullptr);
+		_chunks.reset(new ChunkStream(seed, width, height, CHUNKS_AHEAD, CHUNK_THREADS));
+	}
+	else
+	{
+		int mapsNumber = std::stoi(mapsNumberLine);
+		//check if correct map data
+
+		for (int i = 0; i < mapsNumber; i++)
+		{
+			std::string mapPath;
+			std::getline(levelStream, mapPath);
+			_maps.push_back(mapPath);
+		}
 	}
 
 	//player
@@ -73,7 +106,8 @@ void Level::Load(std::istream& levelStream)
 		throw new Exception(0, "[LEVEL] (3) invalid file input - not enough player data.");
 	}
 
-	_player = new Player(body, maxHp, jumpHeight);
+	_player = _arena->New<Player>(body, maxHp, jumpHeight);
+	_spawn = _player->TopLeft();
 	
 	//highscore
 	std::string scoreInput;
@@ -91,56 +125,302 @@ void Level::Load(std::istream& levelStream)
 
 void Level::LoadMap(const int& mapIndex)
 {
-	_currentMapIndex = mapIndex;
-	if (_currentMapIndex >= static_cast<int>(_maps.size()) or _currentMapIndex < 0)
+	if ((_chunks == nullptr and mapIndex >= static_cast<int>(_maps.size())) or mapIndex < 0)
 	{
 		throw new Exception(2, "[MAP] map index out of size.");
 	}
 
-	std::ifstream mapStream(_maps[_currentMapIndex]);
-	
-	if (mapStream.good())
+	FinishRooms();
+	std::unique_ptr<Arena> mapArena(new Arena());
+	Map* map = BuildRoom(mapIndex, mapArena.get());
+
+	if (_roomInterval > 0)
 	{
-		_map = new Map(mapStream);
-		AssignOptionTiles();
+		//the room left keeps running with the others, the loaded one replaces its live copy
+		if (mapIndex != _currentMapIndex)
+		{
+			_map->SetScreen(nullptr);
+			_roomTicks[_currentMapIndex] = _ticks;
+		}
+
+		_roomArenas[mapIndex] = std::move(mapArena);
+		_rooms[mapIndex] = map;
+		_roomTicks[mapIndex] = _ticks;
+		_currentMapIndex = mapIndex;
+		UpdateDynamicRooms();
 	}
 	else
 	{
-		throw new Exception(1, "[MAP] file open error.");
+		//the previous room goes away with its arena
+		_mapArena = std::move(mapArena);
+		_currentMapIndex = mapIndex;
 	}
 
-	mapStream.close();
+	_map = map;
+	_mapLoads++;
 }
 
-Player* Level::GetPlayer()
+Map* Level::BuildRoom(const int& mapIndex, Arena* arena)
 {
-	return _player;
+	ArenaScope scope(arena);
+	Map* map = nullptr;
+
+	if (_chunks != nullptr)
+	{
+		std::shared_ptr<const Map> prototype = _chunks->Get(mapIndex);
+		map = arena->New<Map>(*prototype);
+		map->SetScreen(_screen);
+	}
+	else if (_mapLibrary != nullptr)
+	{
+		std::shared_ptr<const Map> prototype = _mapLibrary->Get(_maps[mapIndex]);
+		map = arena->New<Map>(*prototype);
+		map->SetScreen(_screen);
+	}
+	else
+	{
+		std::ifstream mapStream(_maps[mapIndex]);
+
+		if (mapStream.good())
+		{
+			map = arena->New<Map>(mapStream, _screen);
+		}
+		else
+		{
+			throw new Exception(1, "[MAP] file open error.");
+		}
+
+		mapStream.close();
+	}
+
+	return map;
 }
 
-Map* Level::GetMap()
+void Level::EnterMap(const int& mapIndex)
 {
-	return _map;
+	if (_roomInterval == 0)
+	{
+		LoadMap(mapIndex);
+		return;
+	}
+
+	if (mapIndex >= static_cast<int>(_rooms.size()) or mapIndex < 0)
+	{
+		throw new Exception(2, "[MAP] map index out of size.");
+	}
+
+	if (mapIndex == _currentMapIndex)
+	{
+		return;
+	}
+
+	FinishRooms();
+	_map->SetScreen(nullptr);
+	_roomTicks[_currentMapIndex] = _ticks;
+
+	//ticks since the room's last batch, nothing is drawn until the game shows the room
+	Map* room = _rooms[mapIndex];
+	std::vector<Position> changedPositions;
+	room->SetTicks(room->GetTicks() + _ticks - _roomTicks[mapIndex], changedPositions);
+	room->SetScreen(_screen);
+	_roomTicks[mapIndex] = _ticks;
+
+	_currentMapIndex = mapIndex;
+	_map = room;
+	_mapLoads++;
+}
+
+void Level::KeepRoomsLive(const int& interval)
+{
+	if (_chunks != nullptr or interval < 1 or _roomInterval > 0)
+	{
+		return; //chunks behind the player are forgotten, an endless level has no rooms to keep
+	}
+
+	_roomInterval = interval;
+	_roomArenas.resize(_maps.size());
+	_rooms.assign(_maps.size(), nullptr);
+	_roomTicks.assign(_maps.size(), _ticks);
+
+	for (int i = 0; i < static_cast<int>(_maps.size()); i++)
+	{
+		if (i == _currentMapIndex)
+		{
+			_roomArenas[i] = std::move(_mapArena);
+			_rooms[i] = _map;
+		}
+		else
+		{
+			_roomArenas[i].reset(new Arena());
+			_rooms[i] = BuildRoom(i, _roomArenas[i].get());
+			_rooms[i]->SetScreen(nullptr);
+		}
+	}
+
+	UpdateDynamicRooms();
+	_roomWorker.reset(new WorkStealingPool(1));
+}
+
+void Level::ReloadRoom(const int& mapIndex)
+{
+	if (mapIndex < 0 or mapIndex >= static_cast<int>(_rooms.size()) or mapIndex == _currentMapIndex)
+	{
+		return;
+	}
+
+	//the worker may be advancing the room
+	FinishRooms();
+
+	std::ifstream mapStream(_maps[mapIndex]);
+	std::vector<Position> changedPositions;
+
+	if (!_rooms[mapIndex]->Patch(mapStream, changedPositions))
+	{
+		std::unique_ptr<Arena> roomArena(new Arena());
+		Map* room = BuildRoom(mapIndex, roomArena.get());
+		room->SetScreen(nullptr);
+		_roomArenas[mapIndex] = std::move(roomArena);
+		_rooms[mapIndex] = room;
+		_roomTicks[mapIndex] = _ticks;
+	}
+
+	UpdateDynamicRooms(); //the edits may have added or removed timed tiles
+}
+
+void Level::AdvanceRooms()
+{
+	_ticks++;
+
+	if (_roomInterval == 0 or _ticks % _roomInterval != 0)
+	{
+		return;
+	}
+
+	//the batch before had interval ticks to finish, it is only waited for if the worker fell behind
+	FinishRooms();
+	_batch.clear();
+
+	for (const int& room : _dynamicRooms)
+	{
+		if (room != _currentMapIndex)
+		{
+			_batch.push_back({ _rooms[room], _ticks - _roomTicks[room] });
+			_roomTicks[room] = _ticks;
+		}
+	}
+
+	if (_batch.empty())
+	{
+		return;
+	}
+
+	_roomBatches++;
+	_roomSteps += static_cast<long long>(_batch.size());
+
+	//off-screen rooms draw nothing, toggles only change their cells, collision and triggers
+	_roomWorker->Submit([this]()
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::vector<Position> changedPositions;
+
+		for (const std::pair<Map*, int>& room : _batch)
+		{
+			room.first->SetTicks(room.first->GetTicks() + room.second, changedPositions);
+			changedPositions.clear();
+		}
+
+		_roomNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	});
 }
 
-void Level::AssignOptionTiles()
+void Level::FinishRooms()
 {
-	_optionTiles = {};
+	if (_roomWorker != nullptr)
+	{
+		_roomWorker->Wait();
+	}
+}
 
-	for (int i = 0; i < _map->GetWidth(); i++)
+void Level::UpdateDynamicRooms()
+{
+	_dynamicRooms.clear();
+
+	for (int i = 0; i < static_cast<int>(_rooms.size()); i++)
 	{
-		for (int j = 0; j < _map->GetHeight(); j++)
+		if (_rooms[i]->TimedTilesNumber() > 0)
 		{
-			if (_map->At({ i, j }).GetOptions().size() > 0)
-			{
-				_optionTiles.push_back(_map->At({ i,j }));
-			}
+			_dynamicRooms.push_back(i);
 		}
 	}
 }
 
-std::vector<EntityTile> Level::GetOptionTiles() const
+Player* Level::GetPlayer()
+{
+	return _player;
+}
+
+Position Level::GetSpawn() const
+{
+	return _spawn;
+}
+
+Map* Level::GetMap()
+{
+	return _map;
+}
+
+int Level::GetMapIndex() const
+{
+	return _currentMapIndex;
+}
+
+int Level::GetMapLoads() const
 {
-	return _optionTiles;
+	return _mapLoads;
+}
+
+int Level::LiveRooms() const
+{
+	return static_cast<int>(_rooms.size());
+}
+
+int Level::DynamicRooms() const
+{
+	return static_cast<int>(_dynamicRooms.size());
+}
+
+long long Level::RoomBatches() const
+{
+	return _roomBatches;
+}
+
+long long Level::RoomSteps() const
+{
+	return _roomSteps;
+}
+
+double Level::RoomMicroseconds() const
+{
+	return _roomNanoseconds / 1000.0;
+}
+
+std::vector<std::string> Level::GetMapFilenames() const
+{
+	return _maps;
+}
+
+ChunkStream* Level::GetChunkStream()
+{
+	return _chunks.get();
+}
+
+void Level::CollectScore(const Position& position, const char& character, const int& tileColor, const int& backgroundColor)
+{
+	//change to different tile in original map & remove gold option
+	_map->SetCharacterAt(position, character);
+	_map->RemoveOptionAt(position, OPTION::ADD_SCORE);
+	_map->SetTileColorAt(position, tileColor);
+	_map->SetTileBackgroundColorAt(position, backgroundColor);
 }
 
 void Level::AddScore(const int& amount)
@@ -153,11 +433,21 @@ int Level::GetScore() const
 	return _score;
 }
 
+void Level::SetScore(const int& score)
+{
+	_score = score;
+}
+
 void Level::End()
 {
 	_ended = true;
 }
 
+void Level::Resume()
+{
+	_ended = false;
+}
+
 bool Level::Ended() const
 {
 	return _ended;
@@ -168,29 +458,7 @@ int Level::GetHighscore() const
 	return _highscore;
 }
 
-void Level::SetHighscore(std::iostream& levelStream)
+void Level::SetHighscore(const int& highscore)
 {
-	_highscore = _score;
-	std::string lines;
-	std::getline(levelStream, lines);
-
-	std::vector<std::string> fileData;
-
-	for (int i = 0; i <= /*for player data too*/ std::stoi(lines); i++)
-	{
-		std::string temp;
-		std::getline(levelStream, temp);
-		fileData.push_back(temp);
-	}
-
-	//write to file
-	levelStream.clear();
-	levelStream.seekg(0, std::ios::beg);
-
-	levelStream << (lines + "\n");
-	for (const std::string& line : fileData)
-	{
-		levelStream << (line + "\n");
-	}
-	levelStream << _highscore;
+	_highscore = highscore;
 }
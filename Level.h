@@ -1,7 +1,12 @@
 #pragma once
 #include "Map.h"
+#include "MapLibrary.h"
+#include "ChunkStream.h"
 #include "Player.h"
 #include "Exception.h"
+#include "Arena.h"
+#include <memory>
+#include <atomic>
 #include <fstream>
 #include <sstream>
 #include <Windows.h>
@@ -9,30 +14,72 @@
 class Level
 {
 private:
-	Map* _map = nullptr;
+	std::unique_ptr<Arena> _arena; //player and everything else that lives as long as the level
+	std::unique_ptr<Arena> _mapArena; //current room, replaced on every LoadMap
+	Map* _map = nullptr; //in _mapArena
 	std::vector<std::string> _maps; //for different rooms
 	int _currentMapIndex;
-	Player* _player = nullptr;
-	std::vector<EntityTile> _optionTiles;
+	int _mapLoads; //rooms loaded or entered so far, every LoadMap makes a fresh copy of its room
+	Player* _player = nullptr; //in _arena
+	Position _spawn; //top left of the player as the level file puts it
 	int _score;
 	bool _ended;
 	int _highscore;
+	Screen* _screen = nullptr; //not owned
+	MapLibrary* _mapLibrary = nullptr; //not owned, maps are read from their files without it
+	std::unique_ptr<ChunkStream> _chunks; //endless level - rooms are generated chunks, nullptr - rooms are the .map files
+
+	//live rooms: every room stays in memory as it was left, the current one runs at full rate with the game,
+	//the others with timed tiles are advanced every _roomInterval ticks in one batch on _roomWorker
+	int _roomInterval; //0 - rooms are not kept, entering one loads it again
+	int _ticks; //counted by AdvanceRooms
+	std::vector<std::unique_ptr<Arena>> _roomArenas; //[room], the current one too (_mapArena is unused)
+	std::vector<Map*> _rooms; //[room], in _roomArenas
+	std::vector<int> _roomTicks; //[room] - _ticks the room's clock was last brought to
+	std::vector<int> _dynamicRooms; //rooms with timed tiles, the only ones a batch looks at
+	std::vector<std::pair<Map*, int>> _batch; //rooms of the batch in flight and the ticks they advance by
+	long long _roomBatches;
+	long long _roomSteps; //rooms advanced by the batches
+	std::atomic<long long> _roomNanoseconds; //spent by the worker on the batches
+	std::unique_ptr<WorkStealingPool> _roomWorker; //after the rooms - its thread is joined before they go away
+
+	static const int CHUNKS_AHEAD = 3;
+	static const int CHUNK_THREADS = 2;
+
+	Map* BuildRoom(const int& mapIndex, Arena* arena); //a fresh copy of the room in arena
+	void FinishRooms(); //waits for the batch in flight
+	void UpdateDynamicRooms();
 
 public:
 
-	Level(std::istream& levelStream);
+	Level(std::istream& levelStream, Screen* screen = nullptr, MapLibrary* mapLibrary = nullptr);
 	~Level();
 	void Load(std::istream& levelStream); //loads .level file
 	void LoadMap(const int& mapIndex); //changes _currentMapIndex and set _map to new Map
+	void EnterMap(const int& mapIndex); //the player goes to the room: a live room as it was left, brought up to the current tick, otherwise LoadMap
+	void KeepRoomsLive(const int& interval); //loads every room and keeps them, the ones not entered are advanced every interval ticks on a worker (not in an endless level)
+	void ReloadRoom(const int& mapIndex); //a kept room other than the current one takes the edits of its file, the file is read again whole if its size changed
+	void AdvanceRooms(); //one tick of the level, called after the current room's timers
 	Player* GetPlayer();
+	Position GetSpawn() const;
 	Map* GetMap();
-	void AssignOptionTiles();
-	std::vector<EntityTile> GetOptionTiles() const;
+	int GetMapIndex() const;
+	int GetMapLoads() const; //a new number means the current room is another map object
+	int LiveRooms() const; //0 - rooms are not kept live
+	int DynamicRooms() const;
+	long long RoomBatches() const;
+	long long RoomSteps() const;
+	double RoomMicroseconds() const; //worker time of all batches so far
+	std::vector<std::string> GetMapFilenames() const; //none in an endless level
+	ChunkStream* GetChunkStream(); //nullptr - not an endless level
+	void CollectScore(const Position& position, const char& character, const int& tileColor, const int& backgroundColor); //changes ADD_SCORE tile to its collected look and removes the option
 	void AddScore(const int& amount);
 	int GetScore() const;
+	void SetScore(const int& score);
 	void End();
+	void Resume(); //undoes End()
 	bool Ended() const;
 	int GetHighscore() const;
-	void SetHighscore(std::iostream& levelStream);
+	void SetHighscore(const int& highscore);
 };
 
@@ -0,0 +1,361 @@
+#include "LevelSolver.h"
+
+//bits of KEY - UP 1, LEFT 4, RIGHT 8
+const int LevelSolver::INPUTS[6] = { 0, 4, 8, 1, 1 | 4, 1 | 8 };
+
+// packed state, low to high bits:
+// room 6 | x 11 | y 11 | jumping 1 | jumping frame 6 | hp 8 | collected pickups 20
+
+LevelSolver::LevelSolver(const int& threads, const int& capacityBits)
+{
+	_threads = threads;
+	_capacityBits = capacityBits;
+	_positiveScore = 0;
+}
+
+unsigned long long LevelSolver::Pack(const State& state)
+{
+	if (state.room < 0 or state.room >= (1 << 6) or state.x < 0 or state.x >= (1 << 11) or state.y < 0 or state.y >= (1 << 11)
+		or state.jumpingFrame < 0 or state.jumpingFrame >= (1 << 6) or state.hp < 0 or state.hp >= (1 << 8) or state.collected >= (1u << 20))
+	{
+		throw new Exception(2, "[SOLVER] game state does not fit the packed state.");
+	}
+
+	unsigned long long key = static_cast<unsigned long long>(state.room);
+	key |= static_cast<unsigned long long>(state.x) << 6;
+	key |= static_cast<unsigned long long>(state.y) << 17;
+	key |= static_cast<unsigned long long>(state.jumping ? 1 : 0) << 28;
+	key |= static_cast<unsigned long long>(state.jumpingFrame) << 29;
+	key |= static_cast<unsigned long long>(state.hp) << 35;
+	key |= static_cast<unsigned long long>(state.collected) << 43;
+	return key;
+}
+
+LevelSolver::State LevelSolver::Unpack(const unsigned long long& key)
+{
+	State state;
+	state.room = static_cast<int>(key & 0x3f);
+	state.x = static_cast<int>((key >> 6) & 0x7ff);
+	state.y = static_cast<int>((key >> 17) & 0x7ff);
+	state.jumping = ((key >> 28) & 1) != 0;
+	state.jumpingFrame = static_cast<int>((key >> 29) & 0x3f);
+	state.hp = static_cast<int>((key >> 35) & 0xff);
+	state.collected = static_cast<unsigned int>((key >> 43) & 0xfffff);
+	return state;
+}
+
+std::unique_ptr<LevelSolver::Worker> LevelSolver::TakeWorker()
+{
+	{
+		std::lock_guard<std::mutex> lock(_workersMutex);
+		if (!_idleWorkers.empty())
+		{
+			std::unique_ptr<Worker> worker = std::move(_idleWorkers.back());
+			_idleWorkers.pop_back();
+			return worker;
+		}
+	}
+
+	std::unique_ptr<Worker> worker(new Worker());
+	worker->input = new ManualInput();
+	worker->game.reset(new Game({ _levelFilename }, new NullScreen(), worker->input, &_mapLibrary));
+	worker->game->StartLevel(0);
+	worker->room = worker->game->GetLevel()->GetMapIndex();
+	worker->collected = 0;
+	return worker;
+}
+
+void LevelSolver::ReturnWorker(std::unique_ptr<Worker> worker)
+{
+	std::lock_guard<std::mutex> lock(_workersMutex);
+	_idleWorkers.push_back(std::move(worker));
+}
+
+void LevelSolver::LoadPickups(Worker& worker)
+{
+	_pickups = {};
+	_positiveScore = 0;
+
+	for (const std::string& mapFilename : worker.game->GetLevel()->GetMapFilenames())
+	{
+		std::shared_ptr<const Map> map = _mapLibrary.Get(mapFilename);
+		std::vector<Position> pickups;
+
+		for (int i = 0; i < map->GetWidth(); i++)
+		{
+			for (int j = 0; j < map->GetHeight(); j++)
+			{
+				Option option = map->AtOriginal({ i, j }).GetOption(OPTION::ADD_SCORE);
+				if (option.Good())
+				{
+					pickups.push_back({ i, j });
+					_positiveScore += option.arguments[0] > 0 ? option.arguments[0] : 0;
+				}
+			}
+		}
+
+		if (pickups.size() > 20)
+		{
+			throw new Exception(2, "[SOLVER] more than 20 pickups in " + mapFilename + ".");
+		}
+
+		_pickups.push_back(pickups);
+	}
+}
+
+LevelSolver::State LevelSolver::Capture(Worker& worker)
+{
+	Level* level = worker.game->GetLevel();
+	int room = level->GetMapIndex();
+
+	if (room != worker.room)
+	{
+		//the new room is a fresh copy, its pickups are all there
+		worker.room = room;
+		worker.collected = 0;
+	}
+	else
+	{
+		const std::vector<Position>& pickups = _pickups[room];
+		for (int i = 0; i < static_cast<int>(pickups.size()); i++)
+		{
+			if ((worker.collected & (1u << i)) == 0 and !level->GetMap()->AtOriginal(pickups[i]).GetOption(OPTION::ADD_SCORE).Good())
+			{
+				worker.collected |= 1u << i;
+			}
+		}
+	}
+
+	Position topLeft = level->GetPlayer()->TopLeft();
+	return { room, topLeft.x, topLeft.y, worker.game->Jumping(), worker.game->JumpingFrame(), level->GetPlayer()->Hp(), worker.collected };
+}
+
+void LevelSolver::Restore(Worker& worker, const State& state, const int& score)
+{
+	Level* level = worker.game->GetLevel();
+
+	//taken pickups cannot be put back - a fresh copy of the room is loaded instead
+	if (worker.room != state.room or (worker.collected & ~state.collected) != 0)
+	{
+		level->LoadMap(state.room);
+		worker.room = state.room;
+		worker.collected = 0;
+	}
+
+	const std::vector<Position>& pickups = _pickups[state.room];
+	for (int i = 0; i < static_cast<int>(pickups.size()); i++)
+	{
+		if ((state.collected & ~worker.collected & (1u << i)) != 0)
+		{
+			Option option = level->GetMap()->AtOriginal(pickups[i]).GetOption(OPTION::ADD_SCORE);
+			level->CollectScore(pickups[i], static_cast<char>(option.arguments[1]), option.arguments[2], option.arguments[3]);
+		}
+	}
+
+	worker.collected = state.collected;
+
+	//states carry no clock, timed tiles are searched as they are when the room is entered
+	std::vector<Position> changedPositions;
+	level->GetMap()->SetTicks(0, changedPositions);
+
+	Position topLeft = { state.x, state.y };
+	level->GetPlayer()->SetPosition(topLeft);
+	level->GetPlayer()->SetHp(state.hp);
+	level->SetScore(score);
+	level->Resume();
+	worker.game->SetJumping(state.jumping, state.jumpingFrame);
+}
+
+LevelSolver::Result LevelSolver::Solve(WorkStealingPool& pool, const std::string& levelFilename)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	Result result;
+	result.level = levelFilename;
+	result.exitReachable = false;
+	result.minTicks = -1;
+	result.maxExitScore = INT_MIN;
+	result.farmable = false;
+	result.states = 0;
+
+	_levelFilename = levelFilename;
+	_idleWorkers.clear();
+
+	try
+	{
+		StateSet visited(_capacityBits);
+		std::vector<Entry> frontier;
+
+		{
+			std::unique_ptr<Worker> worker = TakeWorker();
+			LoadPickups(*worker);
+
+			Entry entry;
+			entry.key = Pack(Capture(*worker));
+			visited.Insert(entry.key, entry.slot);
+			visited.RaiseScore(entry.slot, 0);
+			frontier.push_back(entry);
+			ReturnWorker(std::move(worker));
+		}
+
+		std::atomic<int> minTicks(-1);
+		std::atomic<int> maxExitScore(INT_MIN);
+		std::atomic<bool> farmable(false);
+		std::mutex errorMutex;
+		std::string error;
+
+		for (int depth = 1; !frontier.empty(); depth++)
+		{
+			int chunkSize = static_cast<int>(frontier.size()) / (pool.Threads() * 4) + 1;
+			if (chunkSize < 64)
+			{
+				chunkSize = 64;
+			}
+
+			int chunks = (static_cast<int>(frontier.size()) + chunkSize - 1) / chunkSize;
+			std::vector<std::vector<Entry>> next(chunks);
+
+			for (int chunk = 0; chunk < chunks; chunk++)
+			{
+				pool.Submit([&, chunk, chunkSize, depth]()
+				{
+					std::unique_ptr<Worker> worker;
+
+					try
+					{
+						worker = TakeWorker();
+						int end = (chunk + 1) * chunkSize < static_cast<int>(frontier.size()) ? (chunk + 1) * chunkSize : static_cast<int>(frontier.size());
+
+						for (int i = chunk * chunkSize; i < end; i++)
+						{
+							State state = Unpack(frontier[i].key);
+							int score = visited.Score(frontier[i].slot);
+
+							for (const int& keys : INPUTS)
+							{
+								Restore(*worker, state, score);
+								worker->input->SetKeys(keys);
+								worker->game->Tick();
+
+								Level* level = worker->game->GetLevel();
+								if (level->GetPlayer()->Dead())
+								{
+									continue;
+								}
+
+								int newScore = level->GetScore();
+								if (level->Ended())
+								{
+									int ticks = minTicks;
+									while ((ticks < 0 or depth < ticks) and !minTicks.compare_exchange_weak(ticks, depth)) {}
+
+									int best = maxExitScore;
+									while (newScore > best and !maxExitScore.compare_exchange_weak(best, newScore)) {}
+									continue;
+								}
+
+								if (newScore > _positiveScore)
+								{
+									farmable = true;
+								}
+
+								Entry entry;
+								entry.key = Pack(Capture(*worker));
+								bool added = visited.Insert(entry.key, entry.slot);
+								bool improved = visited.RaiseScore(entry.slot, newScore);
+
+								//a better score is searched again from that state, unless scores can grow forever
+								if (added or (improved and !farmable))
+								{
+									next[chunk].push_back(entry);
+								}
+							}
+						}
+					}
+					catch (Exception* exception)
+					{
+						worker.reset(); //its game may be half way through a tick
+
+						std::lock_guard<std::mutex> lock(errorMutex);
+						error = exception->Message();
+						delete exception;
+					}
+
+					if (worker != nullptr)
+					{
+						ReturnWorker(std::move(worker));
+					}
+				});
+			}
+
+			pool.Wait();
+
+			if (!error.empty())
+			{
+				throw new Exception(2, error);
+			}
+
+			frontier = {};
+			for (std::vector<Entry>& chunkEntries : next)
+			{
+				frontier.insert(frontier.end(), chunkEntries.begin(), chunkEntries.end());
+			}
+		}
+
+		result.exitReachable = minTicks >= 0;
+		result.minTicks = minTicks;
+		result.maxExitScore = maxExitScore;
+		result.farmable = farmable;
+		result.states = visited.Size();
+	}
+	catch (Exception* exception)
+	{
+		result.error = exception->Message();
+		delete exception;
+	}
+
+	_idleWorkers.clear();
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+void LevelSolver::Run(const std::vector<std::string>& levels, std::ostream& reportStream)
+{
+	Sound::muted = true;
+
+	WorkStealingPool pool(_threads);
+	long long states = 0;
+	double seconds = 0.0;
+	int unreachable = 0;
+	int failed = 0;
+
+	reportStream << std::fixed << std::setprecision(2);
+
+	for (const std::string& levelFilename : levels)
+	{
+		Result result = Solve(pool, levelFilename);
+		states += result.states;
+		seconds += result.seconds;
+
+		reportStream << result.level << ": ";
+		if (!result.error.empty())
+		{
+			failed++;
+			reportStream << result.error;
+		}
+		else if (!result.exitReachable)
+		{
+			unreachable++;
+			reportStream << "EXIT NOT REACHABLE";
+		}
+		else
+		{
+			reportStream << "exit in " << result.minTicks << " ticks, max exit score " << result.maxExitScore << (result.farmable ? " (farmable - pickups respawn)" : "");
+		}
+
+		reportStream << ", states: " << result.states << " in " << result.seconds << " s - " << (result.seconds > 0.0 ? result.states / result.seconds : 0.0) << " states/s\n";
+	}
+
+	reportStream << "levels: " << levels.size() << " (" << unreachable << " unreachable, " << failed << " failed), threads: " << pool.Threads() << ", steals: " << pool.Steals() << "\n";
+	reportStream << "states: " << states << " in " << seconds << " s - " << (seconds > 0.0 ? states / seconds : 0.0) << " states/s\n";
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include "Game.h"
+#include "MapLibrary.h"
+#include "WorkStealingPool.h"
+#include "StateSet.h"
+
+// offline level check: breadth-first search over every reachable game state, played by headless games with the real Tick
+// every depth of the search is split into chunks expanded in parallel, visited states go to one lock-free StateSet
+
+class LevelSolver
+{
+public:
+	struct Result
+	{
+		std::string level;
+		std::string error; //empty - the search finished
+		bool exitReachable;
+		int minTicks; //ticks to the nearest EXIT_LEVEL tile
+		int maxExitScore;
+		bool farmable; //pickups respawn when a room is entered again, so the score has no upper bound
+		long long states;
+		double seconds;
+	};
+
+private:
+	struct State
+	{
+		int room;
+		int x;
+		int y;
+		bool jumping;
+		int jumpingFrame;
+		int hp;
+		unsigned int collected; //bit i - pickup i of the room was taken
+	};
+
+	struct Entry
+	{
+		unsigned long long key;
+		long long slot; //slot of the key in the StateSet, holds the best score
+	};
+
+	struct Worker //headless game reused for many states
+	{
+		std::unique_ptr<Game> game;
+		ManualInput* input; //owned by game
+		int room; //room and pickups the game's map currently has
+		unsigned int collected;
+	};
+
+	static const int INPUTS[6]; //nothing, left, right, up, up-left, up-right
+
+	int _threads;
+	int _capacityBits;
+	MapLibrary _mapLibrary; //maps parsed once for every worker game and level
+	std::string _levelFilename; //level being solved
+	std::vector<std::vector<Position>> _pickups; //ADD_SCORE tiles of every room of the level, x-major order
+	int _positiveScore; //sum of all positive pickups of the level, any higher score means a pickup was taken twice
+	std::vector<std::unique_ptr<Worker>> _idleWorkers;
+	std::mutex _workersMutex;
+
+	static unsigned long long Pack(const State& state);
+	static State Unpack(const unsigned long long& key);
+	std::unique_ptr<Worker> TakeWorker();
+	void ReturnWorker(std::unique_ptr<Worker> worker);
+	State Capture(Worker& worker); //state of the worker's game after a tick
+	void Restore(Worker& worker, const State& state, const int& score);
+	void LoadPickups(Worker& worker);
+
+public:
+	LevelSolver(const int& threads = 0, const int& capacityBits = 22); //capacity 2^capacityBits states per level
+	Result Solve(WorkStealingPool& pool, const std::string& levelFilename);
+	void Run(const std::vector<std::string>& levels, std::ostream& reportStream); //solves levels one after another and reports each one
+};
@@ -1,7 +1,8 @@
 #include "Map.h"
 
-Map::Map(std::istream& mapStream)
+Map::Map(std::istream& mapStream, Screen* screen)
 {
+	_screen = screen;
 	Load(mapStream);
 }
 
@@ -12,14 +13,20 @@ void Map::Load(std::istream& mapStream)
 	std::stringstream mapSize(mapSizeLine);
 	mapSize >> _width;
 	mapSize >> _height;
+	int viewRadius = 0; //optional, a dark room
+	mapSize >> viewRadius;
 
-	std::vector<std::vector<EntityTile>> map(_width, std::vector<EntityTile>(_height, EntityTile('*', { 0,0 }, {})));
+	//a text that repeats is parsed once, every cell only gets the id of its archetype
+	_archetypes.Clear();
+	TileGrid map(_width * _height);
+	std::unordered_map<std::string, unsigned int> parsedTiles;
 
 	for (int i = 0; i < _height; i++)
 	{
 		std::string rowLine;
 		std::getline(mapStream, rowLine);
 		std::stringstream row(rowLine);
+		_rows.push_back(RowText(rowLine.begin(), rowLine.end()));
 
 		for (int j = 0; j < _width; j++)
 		{
@@ -29,87 +36,334 @@ void Map::Load(std::istream& mapStream)
 				throw new Exception(0, "[MAP] invalid file input - not enough tiles data.");
 			}
 			
-			std::vector<Option> options;
-			std::istringstream optionsStream(tileData.substr(1));
-			std::string option;
-			std::string tileColor = "\u001b[37m"; //white
-			std::string backgroundColor = "\u001b[30m"; //black
-			while (std::getline(optionsStream, option, '/'))
+			std::unordered_map<std::string, unsigned int>::iterator parsed = parsedTiles.find(tileData);
+			if (parsed == parsedTiles.end())
 			{
-				std::vector<int> arguments = {};
-				OPTION optionName = OPTION::OPTION_ERROR;
-				std::istringstream argumentsStream(option.substr(1));
-				std::string argument;
-				
-				while (std::getline(argumentsStream, argument, ','))
-				{
-					arguments.push_back(std::stoi(argument));
-				}
-
-				switch (option[0])
-				{
-				case 'c': //collidable
-					optionName = OPTION::COLLIDABLE;
-					break;
-
-				case 's': //switch map
-					optionName = OPTION::SWITCH_MAP;
-					break;
-
-				case 'd': //damage
-					optionName = OPTION::DEAL_DMG;
-					break;
-
-				case 'g': //score (gold)
-					optionName = OPTION::ADD_SCORE;
-					break;
-
-				case 'e': //exit level
-					optionName = OPTION::EXIT_LEVEL;
-					break;
-
-				case 'f':  //tile color
-					tileColor = Tile::TileColor(arguments[0]);
-					break;
-
-				case 'b': //backrogund color
-					backgroundColor = Tile::BackgroundColor(arguments[0]);
-					break;
-
-				default:
-					throw new Exception(4, "[OPTION] invalid option name at {" + std::to_string(j) + ", " + std::to_string(i) + "}.");
-					break;
-				}
-
-				options.push_back({ optionName, arguments });
+				parsed = parsedTiles.insert({ tileData, _archetypes.Intern(ParseTile(tileData, { j, i })) }).first;
 			}
-			
-			map[j][i] = EntityTile(tileData[0], { j, i }, options, tileColor, backgroundColor);
 
-			if (map[j][i].GetOption(OPTION::COLLIDABLE).Good())
+			map[j * _height + i] = parsed->second;
+		}
+	}
+
+	_map = map;
+	_originalMap.assign(map.begin(), map.end());
+
+	_solidBelow = SolidGrid(_width, SolidColumn(_height, _height));
+	for (int x = 0; x < _width; x++)
+	{
+		UpdateColumn(x);
+	}
+
+	_view = FieldOfView(_width, _height, viewRadius);
+	if (_view.Dark())
+	{
+		for (int x = 0; x < _width; x++)
+		{
+			for (int y = 0; y < _height; y++)
 			{
-				_collidingPositions.push_back({ j,i });
+				_view.SetOpaque({ x, y }, _solidBelow[x][y] == y);
 			}
 		}
 	}
 
-	_map = map;
-	_originalMap = map;
+	_flow = FlowField(); //searched when something first follows the player
+
+	_triggers.clear();
+	_triggerOps.clear();
+	_triggerRanges.assign(_width * _height, TriggerRange{ 0, 0 });
+	_timedTiles.clear();
+	for (int x = 0; x < _width; x++)
+	{
+		for (int y = 0; y < _height; y++)
+		{
+			CompileTriggers({ x, y });
+
+			if (AtOriginal({ x, y }).HasOption(OPTION::TIMED))
+			{
+				AddTimedTile({ x, y });
+			}
+		}
+	}
+
+	ScheduleTimers(0);
 }
 
-EntityTile& Map::At(const Position& position)
+EntityTile Map::ParseTile(const std::string& tileData, const Position& position)
+{
+	std::vector<Option> options;
+	std::istringstream optionsStream(tileData.substr(1));
+	std::string option;
+	std::string tileColor = "\u001b[37m"; //white
+	std::string backgroundColor = "\u001b[30m"; //black
+	while (std::getline(optionsStream, option, '/'))
+	{
+		if (option.empty())
+		{
+			throw new Exception(4, "[OPTION] empty option at {" + std::to_string(position.x) + ", " + std::to_string(position.y) + "}.");
+		}
+
+		std::vector<int, ArenaAllocator<int, MEMORY_TAG::OPTIONS>> arguments = {};
+		OPTION optionName = OPTION::OPTION_ERROR;
+		std::istringstream argumentsStream(option.substr(1));
+		std::string argument;
+		
+		while (std::getline(argumentsStream, argument, ','))
+		{
+			//strtol instead of stoi - its exceptions are not Exception*, and a typo in a file edited while the game runs must not end it
+			char* end = nullptr;
+			errno = 0;
+			long value = std::strtol(argument.c_str(), &end, 10);
+			if (argument.empty() or std::isspace(static_cast<unsigned char>(argument[0])) or *end != '\0' or errno == ERANGE or value < INT_MIN or value > INT_MAX)
+			{
+				throw new Exception(4, "[OPTION] invalid option argument at {" + std::to_string(position.x) + ", " + std::to_string(position.y) + "}.");
+			}
+
+			arguments.push_back(static_cast<int>(value));
+		}
+
+		//edited files are parsed while the game runs, so a missing argument must not crash it
+		const OptionKind* kind = OptionKind::Find(option[0]);
+		size_t requiredArguments = kind != nullptr ? kind->requiredArguments : (option[0] == 'f' or option[0] == 'b' ? 1 : 0);
+
+		if (arguments.size() < requiredArguments)
+		{
+			throw new Exception(4, "[OPTION] missing option arguments at {" + std::to_string(position.x) + ", " + std::to_string(position.y) + "}.");
+		}
+
+		if (kind != nullptr)
+		{
+			optionName = kind->option;
+		}
+		else if (option[0] == 'f') //tile color
+		{
+			tileColor = Tile::TileColor(arguments[0]);
+		}
+		else if (option[0] == 'b') //background color
+		{
+			backgroundColor = Tile::BackgroundColor(arguments[0]);
+		}
+		else
+		{
+			throw new Exception(4, "[OPTION] invalid option name at {" + std::to_string(position.x) + ", " + std::to_string(position.y) + "}.");
+		}
+
+		//timed: toggles option arguments[0] every arguments[1] ticks
+		if (optionName == OPTION::TIMED and ((arguments[0] != static_cast<int>(OPTION::COLLIDABLE) and arguments[0] != static_cast<int>(OPTION::DEAL_DMG)) or arguments[1] < 1 or (arguments.size() > 3 and arguments[3] < 0)))
+		{
+			throw new Exception(4, "[OPTION] invalid timed option at {" + std::to_string(position.x) + ", " + std::to_string(position.y) + "}.");
+		}
+
+		options.push_back({ optionName, arguments });
+	}
+
+	//damage switched on by a timer needs its amount from a d option of the same tile
+	for (const Option& option : options)
+	{
+		if (option.optionName == OPTION::TIMED and option.arguments[0] == static_cast<int>(OPTION::DEAL_DMG) and std::none_of(options.begin(), options.end(), [](const Option& other) { return other.optionName == OPTION::DEAL_DMG; }))
+		{
+			throw new Exception(4, "[OPTION] timed damage without damage option at {" + std::to_string(position.x) + ", " + std::to_string(position.y) + "}.");
+		}
+	}
+
+	return EntityTile(tileData[0], position, options, tileColor, backgroundColor);
+}
+
+std::vector<std::string> Map::SplitRow(const std::string& rowLine)
+{
+	std::vector<std::string> tilesData;
+	std::stringstream row(rowLine);
+	std::string tileData;
+
+	while (row >> tileData)
+	{
+		tilesData.push_back(tileData);
+	}
+
+	return tilesData;
+}
+
+bool Map::Patch(std::istream& mapStream, std::vector<Position>& changedPositions)
+{
+	changedPositions = {};
+
+	std::string mapSizeLine;
+	std::getline(mapStream, mapSizeLine);
+	std::stringstream mapSize(mapSizeLine);
+	int width = 0;
+	int height = 0;
+	int viewRadius = 0;
+	mapSize >> width;
+	mapSize >> height;
+	mapSize >> viewRadius;
+
+	if (width != _width or height != _height or viewRadius != _view.GetRadius())
+	{
+		return false;
+	}
+
+	//every edited row is parsed before anything changes, so a half-saved file leaves the map as it was
+	std::vector<EntityTile> patches;
+	std::vector<std::pair<int, std::string>> editedRows;
+
+	for (int i = 0; i < _height; i++)
+	{
+		std::string rowLine;
+		std::getline(mapStream, rowLine);
+
+		if (_rows[i].size() == rowLine.size() and std::equal(rowLine.begin(), rowLine.end(), _rows[i].begin()))
+		{
+			continue;
+		}
+
+		std::vector<std::string> oldTilesData = SplitRow(std::string(_rows[i].begin(), _rows[i].end()));
+		std::vector<std::string> newTilesData = SplitRow(rowLine);
+
+		if (static_cast<int>(newTilesData.size()) < _width)
+		{
+			throw new Exception(0, "[MAP] invalid file input - not enough tiles data.");
+		}
+
+		//only cells whose text changed are replaced - pickups taken elsewhere in the row stay taken
+		for (int j = 0; j < _width; j++)
+		{
+			if (j >= static_cast<int>(oldTilesData.size()) or oldTilesData[j] != newTilesData[j])
+			{
+				patches.push_back(ParseTile(newTilesData[j], { j, i }));
+			}
+		}
+
+		editedRows.push_back({ i, rowLine });
+	}
+
+	bool timedTilesChanged = false;
+
+	for (const EntityTile& tile : patches)
+	{
+		Position position = tile.GetPosition();
+		timedTilesChanged = timedTilesChanged or tile.GetOption(OPTION::TIMED).Good() or AtOriginal(position).GetOption(OPTION::TIMED).Good();
+		bool collidable = tile.HasOption(OPTION::COLLIDABLE);
+		bool wasCollidable = AtOriginal(position).HasOption(OPTION::COLLIDABLE);
+		SetOriginalTile(position, tile);
+		SetTile(position, tile);
+
+		if (collidable != wasCollidable)
+		{
+			UpdateCollision(position, collidable);
+		}
+
+		CompileTriggers(position);
+		Draw(position);
+		changedPositions.push_back(position);
+	}
+
+	if (!patches.empty())
+	{
+		CompactTriggers(); //drops the triggers the patched cells had, so saving again and again does not grow the lists
+	}
+
+	if (timedTilesChanged)
+	{
+		//patched timed tiles start from their file state and catch up with the room's clock, the others keep theirs
+		for (int i = static_cast<int>(_timedTiles.size()) - 1; i >= 0; i--)
+		{
+			if (std::find(changedPositions.begin(), changedPositions.end(), _timedTiles[i].position) != changedPositions.end())
+			{
+				_timedTiles.erase(_timedTiles.begin() + i);
+			}
+		}
+
+		for (const Position& position : changedPositions)
+		{
+			if (AtOriginal(position).GetOption(OPTION::TIMED).Good())
+			{
+				AddTimedTile(position);
+				SetToggled(_timedTiles.back(), ToggledAt(_timedTiles.back(), GetTicks()));
+			}
+		}
+
+		ScheduleTimers(GetTicks());
+	}
+
+	for (const std::pair<int, std::string>& row : editedRows)
+	{
+		_rows[row.first] = RowText(row.second.begin(), row.second.end());
+	}
+
+	return true;
+}
+
+void Map::UpdateColumn(const int& x)
+{
+	int solid = _height;
+
+	for (int y = _height - 1; y >= 0; y--)
+	{
+		if (AtOriginal({ x, y }).HasOption(OPTION::COLLIDABLE))
+		{
+			solid = y;
+		}
+
+		_solidBelow[x][y] = solid;
+	}
+}
+
+void Map::UpdateColumn(const int& x, const int& y)
+{
+	int solid = y + 1 < _height ? _solidBelow[x][y + 1] : _height;
+
+	for (int row = y; row >= 0; row--)
+	{
+		if (AtOriginal({ x, row }).HasOption(OPTION::COLLIDABLE))
+		{
+			if (row != y)
+			{
+				break; //it and the cells above it see it first either way
+			}
+
+			solid = row;
+		}
+
+		_solidBelow[x][row] = solid;
+	}
+}
+
+const EntityTile& Map::At(const Position& position) const
 { 
-	return _map[position.x][position.y]; 
+	return _archetypes.Get(_map[position.x * _height + position.y]);
+}
+
+const EntityTile& Map::AtOriginal(const Position& position) const
+{
+	return _archetypes.Get(_originalMap[position.x * _height + position.y]);
+}
+
+void Map::SetTile(const Position& position, const EntityTile& tile)
+{
+	_map[position.x * _height + position.y] = _archetypes.Intern(tile);
 }
 
-EntityTile& Map::AtOriginal(const Position& position)
+void Map::SetOriginalTile(const Position& position, const EntityTile& tile)
 {
-	return _originalMap[position.x][position.y];
+	_originalMap[position.x * _height + position.y] = _archetypes.Intern(tile);
 }
 
 std::vector<Position> Map::GetCollidingPositions() const
 {
-	return _collidingPositions;
+	std::vector<Position> positions;
+
+	for (int y = 0; y < _height; y++)
+	{
+		for (int x = 0; x < _width; x++)
+		{
+			if (_solidBelow[x][y] == y)
+			{
+				positions.push_back({ x, y });
+			}
+		}
+	}
+
+	return positions;
 }
 
 bool Map::InBoundings(const Position& position) const
@@ -119,14 +373,11 @@ bool Map::InBoundings(const Position& position) const
 
 bool Map::CollidingWith(const std::vector<Position>& positions) const
 {
-	for (Position const& positionA : positions)
+	for (Position const& position : positions)
 	{
-		for (Position const& positionB : _collidingPositions)
+		if (CollidingWith(position))
 		{
-			if ((positionA == positionB) or !InBoundings(positionA))
-			{
-				return true;
-			}
+			return true;
 		}
 	}
 	return false;
@@ -139,7 +390,30 @@ bool Map::CollidingWith(const EntityTile& tile) const
 
 bool Map::CollidingWith(const Position& position) const
 {
-	return CollidingWith({ position });
+	return !InBoundings(position) or _solidBelow[position.x][position.y] == position.y;
+}
+
+int Map::FallDistance(const std::vector<Position>& positions, const int& maxDistance) const
+{
+	int distance = maxDistance;
+
+	for (Position const& position : positions)
+	{
+		Position below = { position.x, position.y + 1 };
+		if (!InBoundings(below))
+		{
+			return 0;
+		}
+
+		//cells between below and the next solid cell are free
+		int freeCells = _solidBelow[below.x][below.y] - below.y;
+		if (freeCells < distance)
+		{
+			distance = freeCells;
+		}
+	}
+
+	return distance;
 }
 
 bool Map::CollidingWith(const std::vector<EntityTile>& tiles) const
@@ -156,18 +430,50 @@ bool Map::CollidingWith(const std::vector<EntityTile>& tiles) const
 
 void Map::UpdateMap(const std::vector<EntityTile>& oldState, const std::vector<EntityTile>& newState)
 {
+	//restore only cells left by the new state, cells covered by both states are overwritten below
 	for (EntityTile const& tile : oldState)
 	{
 		Position tilePosition = tile.GetPosition();
-		At(tilePosition) = AtOriginal(tilePosition);
-		Draw(AtOriginal(tilePosition));
+		bool covered = false;
+
+		for (EntityTile const& newTile : newState)
+		{
+			if (newTile.GetPosition() == tilePosition)
+			{
+				covered = true;
+				break;
+			}
+		}
+
+		if (!covered)
+		{
+			_map[tilePosition.x * _height + tilePosition.y] = _originalMap[tilePosition.x * _height + tilePosition.y];
+			Draw(tilePosition);
+		}
 	}
 
 	for (EntityTile const& tile : newState)
 	{
 		Position tilePosition = tile.GetPosition();
-		At(tilePosition) = tile;
-		Draw(tile);
+		bool unchanged = (At(tilePosition).GetCharacter() == tile.GetCharacter() and At(tilePosition).GetTileColor() == tile.GetTileColor());
+		SetTile(tilePosition, tile);
+
+		if (!unchanged)
+		{
+			Draw(tilePosition);
+		}
+	}
+}
+
+void Map::RestoreCells(const std::vector<EntityTile>& tiles)
+{
+	for (EntityTile const& tile : tiles)
+	{
+		Position tilePosition = tile.GetPosition();
+		if (InBoundings(tilePosition))
+		{
+			_map[tilePosition.x * _height + tilePosition.y] = _originalMap[tilePosition.x * _height + tilePosition.y];
+		}
 	}
 }
 
@@ -181,48 +487,456 @@ int Map::GetWidth() const
 	return _width;
 }
 
-void Map::GotoPosition(const Position& position)
+int Map::ArchetypesNumber() const
+{
+	return _archetypes.Size();
+}
+
+void Map::SetScreen(Screen* screen)
 {
-	COORD coord = { static_cast<short>(position.x), static_cast<short>(position.y) };
-	SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), coord);
+	_screen = screen;
 }
 
-void Map::Draw(const EntityTile& tile) const
+void Map::Draw(const Position& position) const
 {
-	GotoPosition(tile.GetPosition());
-	std::cout << _originalMap[tile.GetPosition().x][tile.GetPosition().y].GetBackgroundColor() << tile.GetTileColor() << tile.GetCharacter() << /* reset colors */ "\u001b[0m";
-	GotoPosition({ 0, _height + 7 });
+	Draw(position, At(position));
+}
+
+void Map::Draw(const Position& position, const EntityTile& tile) const
+{
+	if (_screen == nullptr)
+	{
+		return;
+	}
+
+	_screen->GotoPosition(position);
+	_screen->Write(CellText(position, tile));
+	_screen->GotoPosition({ 0, _height + 7 });
+}
+
+std::string Map::CellText(const Position& position, const EntityTile& tile) const
+{
+	if (not _view.Visible(position))
+	{
+		//fog: cells seen before are remembered in gray as they are in the map, the rest is dark
+		return _view.Explored(position) ? std::string("\u001b[90m") + AtOriginal(position).GetCharacter() + /* reset colors */ "\u001b[0m" : std::string(" ");
+	}
+
+	return AtOriginal(position).GetBackgroundColor() + tile.GetTileColor() + tile.GetCharacter() + /* reset colors */ "\u001b[0m";
+}
+
+int Map::UpdateView(const Position& eye)
+{
+	_viewChanges.clear();
+	if (not _view.Update(eye, _viewChanges))
+	{
+		return 0;
+	}
+
+	for (const Position& position : _viewChanges)
+	{
+		Draw(position);
+	}
+
+	return static_cast<int>(_viewChanges.size());
+}
+
+const FieldOfView& Map::GetView() const
+{
+	return _view;
+}
+
+int Map::UpdateFlowField(const Position& target)
+{
+	if (_flow.Empty() and _width > 0 and _height > 0)
+	{
+		_flow = FlowField(_width, _height);
+		for (int x = 0; x < _width; x++)
+		{
+			for (int y = 0; y < _height; y++)
+			{
+				_flow.SetWall({ x, y }, _solidBelow[x][y] == y);
+			}
+		}
+	}
+
+	return _flow.Update(target);
+}
+
+const FlowField& Map::GetFlowField() const
+{
+	return _flow;
 }
 
 void Map::Show()
 {
-	system("cls");
+	if (_screen == nullptr)
+	{
+		return;
+	}
+
+	_screen->Clear();
 	for (int y = 0; y < _height; y++)
 	{
+		std::string row;
 		for (int x = 0; x < _width; x++)
 		{
-			std::cout << AtOriginal({ x,y }).GetBackgroundColor() << At({ x,y }).GetTileColor() << At({ x,y }).GetCharacter() << /* reset colors */ "\u001b[0m";
+			row += CellText({ x,y }, At({ x,y }));
 		}
-		std::cout << "\n";
+		_screen->Write(row + "\n");
 	}
 }
 
 void Map::SetCharacterAt(const Position& position, const char& character)
 {
-	AtOriginal(position).SetCharacter(character);
+	_edits.push_back({ MAP_EDIT::SET_CHARACTER, position, character });
+	EntityTile tile = AtOriginal(position);
+	tile.SetCharacter(character);
+	SetOriginalTile(position, tile);
 }
 
 void Map::RemoveOptionAt(const Position& position, const OPTION& optionName)
 {
-	AtOriginal(position).RemoveOption(optionName);
+	_edits.push_back({ MAP_EDIT::REMOVE_OPTION, position, static_cast<int>(optionName) });
+
+	if (optionName == OPTION::COLLIDABLE)
+	{
+		SetCollidableAt(position, false);
+		return;
+	}
+
+	EntityTile tile = AtOriginal(position);
+	tile.RemoveOption(optionName);
+	SetOriginalTile(position, tile);
+	SyncTriggers(position);
+}
+
+void Map::SetCollidableAt(const Position& position, const bool& collidable)
+{
+	if (AtOriginal(position).HasOption(OPTION::COLLIDABLE) == collidable)
+	{
+		return;
+	}
+
+	EntityTile tile = AtOriginal(position);
+	if (collidable)
+	{
+		tile.AddOption({ OPTION::COLLIDABLE, {} });
+	}
+	else
+	{
+		tile.RemoveOption(OPTION::COLLIDABLE);
+	}
+
+	SetOriginalTile(position, tile);
+	UpdateCollision(position, collidable);
+}
+
+void Map::UpdateCollision(const Position& position, const bool& collidable)
+{
+	UpdateColumn(position.x, position.y);
+	_view.SetOpaque(position, collidable);
+	_flow.SetWall(position, collidable);
 }
 
 void Map::SetTileColorAt(const Position& position, const int& color)
 {
-	AtOriginal(position).SetColor(color);
+	_edits.push_back({ MAP_EDIT::SET_TILE_COLOR, position, color });
+	EntityTile tile = AtOriginal(position);
+	tile.SetColor(color);
+	SetOriginalTile(position, tile);
 }
 
 void Map::SetTileBackgroundColorAt(const Position& position, const int& color)
 {
-	AtOriginal(position).SetBackgroundColor(color);
-}
\ No newline at end of file
+	_edits.push_back({ MAP_EDIT::SET_BACKGROUND_COLOR, position, color });
+	EntityTile tile = AtOriginal(position);
+	tile.SetBackgroundColor(color);
+	SetOriginalTile(position, tile);
+}
+
+void Map::ApplyEdit(const MapEdit& edit)
+{
+	//recorded on a room whose file was edited since, possibly smaller
+	if (!InBoundings(edit.position))
+	{
+		return;
+	}
+
+	switch (edit.kind)
+	{
+	case MAP_EDIT::SET_CHARACTER:
+		SetCharacterAt(edit.position, static_cast<char>(edit.value));
+		break;
+
+	case MAP_EDIT::REMOVE_OPTION:
+		RemoveOptionAt(edit.position, static_cast<OPTION>(edit.value));
+		break;
+
+	case MAP_EDIT::SET_TILE_COLOR:
+		SetTileColorAt(edit.position, edit.value);
+		break;
+
+	case MAP_EDIT::SET_BACKGROUND_COLOR:
+		SetTileBackgroundColorAt(edit.position, edit.value);
+		break;
+	}
+}
+
+int Map::EditsNumber() const
+{
+	return static_cast<int>(_edits.size());
+}
+
+const MapEdit& Map::GetEdit(const int& index) const
+{
+	return _edits[index];
+}
+
+bool Map::HasEdits(const std::vector<MapEdit>& edits) const
+{
+	if (edits.size() != _edits.size())
+	{
+		return false;
+	}
+
+	for (int i = 0; i < static_cast<int>(edits.size()); i++)
+	{
+		if (edits[i].kind != _edits[i].kind or edits[i].position != _edits[i].position or edits[i].value != _edits[i].value)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Map::AddTimedTile(const Position& position)
+{
+	const EntityTile& tile = AtOriginal(position);
+	Option timed = tile.GetOption(OPTION::TIMED);
+
+	TimedTile timedTile;
+	timedTile.position = position;
+	timedTile.option = tile.GetOption(static_cast<OPTION>(timed.arguments[0]));
+	if (!timedTile.option.Good())
+	{
+		timedTile.option = { static_cast<OPTION>(timed.arguments[0]), {} }; //switched on by the first toggle
+	}
+
+	timedTile.period = timed.arguments[1];
+	timedTile.offset = timed.arguments.size() > 3 ? timed.arguments[3] % timedTile.period : 0;
+	timedTile.characters[0] = tile.GetCharacter();
+	timedTile.characters[1] = static_cast<char>(timed.arguments[2]);
+	timedTile.toggled = false;
+	timedTile.loaded = _originalMap[position.x * _height + position.y];
+	timedTile.archetypes[1] = ToggledArchetype(timedTile, timedTile.loaded, true);
+	timedTile.archetypes[0] = ToggledArchetype(timedTile, timedTile.archetypes[1], false); //options toggled back on come last
+	_timedTiles.push_back(timedTile);
+}
+
+bool Map::SetToggled(TimedTile& timedTile, const bool& toggled)
+{
+	if (timedTile.toggled == toggled)
+	{
+		return false;
+	}
+
+	timedTile.toggled = toggled;
+	Position position = timedTile.position;
+	int cell = position.x * _height + position.y;
+	unsigned int before = _originalMap[cell];
+	bool switchOn = !AtOriginal(position).HasOption(timedTile.option.optionName);
+
+	//toggles are not edits - they follow from the room's clock, which rewinding restores
+	if (before != timedTile.archetypes[toggled ? 0 : 1] and not (toggled and before == timedTile.loaded))
+	{
+		//an edit changed the cell since the last toggle, toggling back gives the edited tile with the timed character
+		timedTile.archetypes[toggled ? 1 : 0] = ToggledArchetype(timedTile, before, toggled);
+		timedTile.archetypes[toggled ? 0 : 1] = ToggledArchetype(timedTile, timedTile.archetypes[toggled ? 1 : 0], not toggled);
+	}
+
+	_originalMap[cell] = timedTile.archetypes[toggled ? 1 : 0];
+
+	if (timedTile.option.optionName == OPTION::COLLIDABLE)
+	{
+		UpdateCollision(position, switchOn);
+	}
+
+	SyncTriggers(position);
+
+	//the player drawn over the cell is drawn again by the game
+	if (_map[cell] == before)
+	{
+		_map[cell] = _originalMap[cell];
+	}
+	else
+	{
+		EntityTile drawn = At(position);
+		drawn.SetCharacter(AtOriginal(position).GetCharacter());
+		SetTile(position, drawn);
+	}
+
+	Draw(position, AtOriginal(position));
+	return true;
+}
+
+unsigned int Map::ToggledArchetype(const TimedTile& timedTile, const unsigned int& archetype, const bool& toggled)
+{
+	EntityTile tile = _archetypes.Get(archetype);
+	if (tile.HasOption(timedTile.option.optionName))
+	{
+		tile.RemoveOption(timedTile.option.optionName);
+	}
+	else
+	{
+		tile.AddOption(timedTile.option.optionName == OPTION::COLLIDABLE ? Option{ OPTION::COLLIDABLE, {} } : timedTile.option);
+	}
+
+	tile.SetCharacter(timedTile.characters[toggled ? 1 : 0]);
+	return _archetypes.Intern(tile);
+}
+
+void Map::ScheduleTimers(const int& ticks)
+{
+	_timers.Reset(ticks);
+
+	for (int i = 0; i < static_cast<int>(_timedTiles.size()); i++)
+	{
+		_timers.Schedule(NextToggle(_timedTiles[i], ticks), i);
+	}
+}
+
+bool Map::ToggledAt(const TimedTile& timedTile, const int& ticks)
+{
+	return ((ticks + timedTile.offset) / timedTile.period) % 2 == 1;
+}
+
+int Map::NextToggle(const TimedTile& timedTile, const int& ticks)
+{
+	return ((ticks + timedTile.offset) / timedTile.period + 1) * timedTile.period - timedTile.offset;
+}
+
+void Map::AdvanceTimers(std::vector<Position>& changedPositions)
+{
+	_expired.clear();
+	_timers.Advance(_expired);
+
+	for (const int& index : _expired)
+	{
+		TimedTile& timedTile = _timedTiles[index];
+		SetToggled(timedTile, !timedTile.toggled);
+		changedPositions.push_back(timedTile.position);
+		_timers.Schedule(NextToggle(timedTile, _timers.Now()), index);
+	}
+}
+
+void Map::SetTicks(const int& ticks, std::vector<Position>& changedPositions)
+{
+	if (ticks == GetTicks())
+	{
+		return;
+	}
+
+	for (TimedTile& timedTile : _timedTiles)
+	{
+		if (SetToggled(timedTile, ToggledAt(timedTile, ticks)))
+		{
+			changedPositions.push_back(timedTile.position);
+		}
+	}
+
+	ScheduleTimers(ticks);
+}
+
+int Map::GetTicks() const
+{
+	return _timers.Now();
+}
+
+int Map::TimedTilesNumber() const
+{
+	return static_cast<int>(_timedTiles.size());
+}
+
+void Map::CompileTriggers(const Position& position)
+{
+	const EntityTile& tile = AtOriginal(position);
+	TriggerRange& range = _triggerRanges[position.x * _height + position.y];
+	range = { static_cast<int>(_triggers.size()), 0 };
+
+	for (const OptionKind& kind : OptionKind::KINDS)
+	{
+		if (kind.effects.empty() or !tile.HasOption(kind.option))
+		{
+			continue;
+		}
+
+		Trigger trigger;
+		trigger.option = kind.option;
+		trigger.enabled = true;
+		trigger.firstOp = static_cast<int>(_triggerOps.size());
+		OptionKind::Compile(tile.GetOption(kind.option), _triggerOps);
+		trigger.opsNumber = static_cast<int>(_triggerOps.size()) - trigger.firstOp;
+		_triggers.push_back(trigger);
+		range.number++;
+	}
+}
+
+void Map::CompactTriggers()
+{
+	std::vector<Trigger, ArenaAllocator<Trigger, MEMORY_TAG::TRIGGERS>> triggers;
+	std::vector<TriggerOp, ArenaAllocator<TriggerOp, MEMORY_TAG::TRIGGERS>> ops;
+
+	for (TriggerRange& range : _triggerRanges)
+	{
+		int first = static_cast<int>(triggers.size());
+
+		for (int i = range.first; i < range.first + range.number; i++)
+		{
+			Trigger trigger = _triggers[i];
+			trigger.firstOp = static_cast<int>(ops.size());
+			ops.insert(ops.end(), _triggerOps.begin() + _triggers[i].firstOp, _triggerOps.begin() + _triggers[i].firstOp + _triggers[i].opsNumber);
+			triggers.push_back(trigger);
+		}
+
+		range.first = first;
+	}
+
+	_triggers.swap(triggers);
+	_triggerOps.swap(ops);
+}
+
+void Map::SyncTriggers(const Position& position)
+{
+	const TriggerRange& range = _triggerRanges[position.x * _height + position.y];
+
+	for (int i = range.first; i < range.first + range.number; i++)
+	{
+		_triggers[i].enabled = AtOriginal(position).HasOption(_triggers[i].option);
+	}
+}
+
+void Map::TriggersAt(const Position& position, int& first, int& number) const
+{
+	if (!InBoundings(position))
+	{
+		first = 0;
+		number = 0;
+		return;
+	}
+
+	const TriggerRange& range = _triggerRanges[position.x * _height + position.y];
+	first = range.first;
+	number = range.number;
+}
+
+const Trigger& Map::GetTrigger(const int& index) const
+{
+	return _triggers[index];
+}
+
+const TriggerOp& Map::GetTriggerOp(const int& index) const
+{
+	return _triggerOps[index];
+}
@@ -1,43 +1,141 @@
 #pragma once
 #include <vector>
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <sstream>
 #include <Windows.h>
 #include <iostream>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cctype>
 
 #include "EntityTile.h"
 #include "Exception.h"
+#include "FieldOfView.h"
+#include "FlowField.h"
+#include "Screen.h"
+#include "TimerWheel.h"
+#include "Trigger.h"
+#include "TileArchetypes.h"
+
+enum class MAP_EDIT { SET_CHARACTER = 0, REMOVE_OPTION = 1, SET_TILE_COLOR = 2, SET_BACKGROUND_COLOR = 3 };
+
+struct MapEdit //one gameplay change of the original map
+{
+	MAP_EDIT kind;
+	Position position;
+	int value; //character, OPTION or color number
+};
 
 class Map
 {
 private:
-	std::vector<std::vector<EntityTile>> _map;
-	std::vector<std::vector<EntityTile>> _originalMap;
-	std::vector<Position> _collidingPositions;
+	//tiles come from the arena of the level (or room) the map is created in
+	typedef std::vector<unsigned int, ArenaAllocator<unsigned int, MEMORY_TAG::TILES>> TileGrid; //[x * _height + y] - archetype id
+	typedef std::vector<unsigned int, ArenaAllocator<unsigned int, MEMORY_TAG::ORIGINAL_TILES>> OriginalGrid; //the same ids, counted apart
+	typedef std::vector<int, ArenaAllocator<int, MEMORY_TAG::COLLISION>> SolidColumn;
+	typedef std::vector<SolidColumn, ArenaAllocator<SolidColumn, MEMORY_TAG::COLLISION>> SolidGrid;
+	typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char, MEMORY_TAG::ROW_TEXT>> RowText;
+
+	struct TimedTile //tile with a TIMED option: t<option>,<period>,<character>[,<offset>]
+	{
+		Position position;
+		Option option; //the toggled option with its arguments
+		int period; //ticks between toggles
+		int offset; //ticks of the first period already gone when the room is loaded
+		char characters[2]; //[0] - as in the file, [1] - while toggled
+		bool toggled; //the option is the opposite of the file
+		unsigned int archetypes[2]; //of the cell untoggled and toggled, toggles only swap them
+		unsigned int loaded; //of the cell as loaded, its options may be in another order than in archetypes[0]
+	};
+
+	struct TriggerRange //triggers of one cell
+	{
+		int first;
+		int number;
+	};
+
+	TileArchetypes _archetypes; //every different tile the map had, cells of both layers are ids into it
+	TileGrid _map; //as drawn, with the player
+	OriginalGrid _originalMap; //without the player, gameplay changes it through the setters
+	SolidGrid _solidBelow; //[x][y] - y of the first collidable cell at or below {x, y}, _height if there is none
+	std::vector<MapEdit, ArenaAllocator<MapEdit, MEMORY_TAG::EDITS>> _edits; //changes made through the setters since the map was loaded, in order
+	std::vector<RowText, ArenaAllocator<RowText, MEMORY_TAG::ROW_TEXT>> _rows; //file text of every row, Patch compares edits with it
+	std::vector<TimedTile, ArenaAllocator<TimedTile, MEMORY_TAG::TIMERS>> _timedTiles;
+	TimerWheel _timers; //payload - index into _timedTiles, now - ticks since the room was loaded
+	std::vector<int> _expired; //reused by AdvanceTimers
+	std::vector<Trigger, ArenaAllocator<Trigger, MEMORY_TAG::TRIGGERS>> _triggers;
+	std::vector<TriggerOp, ArenaAllocator<TriggerOp, MEMORY_TAG::TRIGGERS>> _triggerOps;
+	std::vector<TriggerRange, ArenaAllocator<TriggerRange, MEMORY_TAG::TRIGGERS>> _triggerRanges; //[x * _height + y]
+	FieldOfView _view; //everything is visible unless the size line gives a view radius
+	std::vector<Position> _viewChanges; //reused by UpdateView
+	FlowField _flow; //empty until UpdateFlowField, shared by everything that follows the player
 	int _width;
 	int _height;
+	Screen* _screen = nullptr; //not owned, nothing is drawn without it
+
+	void SetTile(const Position& position, const EntityTile& tile); //the cell as drawn switches to the archetype of tile
+	void SetOriginalTile(const Position& position, const EntityTile& tile); //copy on write - the cell switches to the archetype of tile, the old one stays for the cells that still use it
+	void Draw(const Position& position, const EntityTile& tile) const; //tile's look at position
+	std::string CellText(const Position& position, const EntityTile& tile) const; //how the cell looks with tile in it, fog outside the view of a dark room
+	void UpdateColumn(const int& x); //rebuilds _solidBelow for one column
+	void UpdateColumn(const int& x, const int& y); //after the collidable option of {x, y} changed, only cells up to the next collidable one above change
+	void UpdateCollision(const Position& position, const bool& collidable); //collision, view and flow field after the collidable option of position changed
+	void AddTimedTile(const Position& position); //for the TIMED option of the original tile, as it is in the file
+	bool SetToggled(TimedTile& timedTile, const bool& toggled); //changes and draws the tile, false if it already was
+	unsigned int ToggledArchetype(const TimedTile& timedTile, const unsigned int& archetype, const bool& toggled); //archetype with the option switched and the character of toggled
+	void ScheduleTimers(const int& ticks); //the next toggle of every timed tile after ticks
+	void CompileTriggers(const Position& position); //for the original tile as it is in the file, a patched cell gets new ones
+	void CompactTriggers(); //keeps only the triggers of the cells' ranges, in cell order
+	void SyncTriggers(const Position& position); //enables the triggers whose option the tile has now
+	static bool ToggledAt(const TimedTile& timedTile, const int& ticks);
+	static int NextToggle(const TimedTile& timedTile, const int& ticks); //first toggle after ticks
+	static EntityTile ParseTile(const std::string& tileData, const Position& position); //one tile of a .map row: character followed by /options
+	static std::vector<std::string> SplitRow(const std::string& rowLine);
 
 public:
-	Map(std::istream& mapStream);
-	EntityTile& At(const Position& position);
-	EntityTile& AtOriginal(const Position& position);
+	Map(std::istream& mapStream, Screen* screen = nullptr);
+	//archetypes of the cell, their positions are not the cell's, a reference lasts until the map changes
+	const EntityTile& At(const Position& position) const;
+	const EntityTile& AtOriginal(const Position& position) const;
 	void Load(std::istream& mapStream);
-	std::vector<Position> GetCollidingPositions() const;
+	bool Patch(std::istream& mapStream, std::vector<Position>& changedPositions); //applies an edited version of the file: replaces and redraws only changed cells, false if the map size changed
+	std::vector<Position> GetCollidingPositions() const; //scans the map
 	void UpdateMap(const std::vector<EntityTile>& oldState, const std::vector<EntityTile>& newState);
+	void RestoreCells(const std::vector<EntityTile>& tiles); //puts the original layer back under tiles without drawing, for a room the player leaves
 	bool CollidingWith(const std::vector<EntityTile>& tiles) const;
 	bool CollidingWith(const std::vector<Position>& positions) const;
 	bool CollidingWith(const Position& position) const;
 	bool CollidingWith(const EntityTile& tile) const;
 	bool InBoundings(const Position& position) const;
+	int FallDistance(const std::vector<Position>& positions, const int& maxDistance) const; //how many cells (up to maxDistance) positions can move down before landing
 	int GetHeight() const;
 	int GetWidth() const;
-	static void GotoPosition(const Position& position);
-	void Draw(const EntityTile& tile) const;
+	int ArchetypesNumber() const;
+	void SetScreen(Screen* screen);
+	void Draw(const Position& position) const; //the cell as it is now
 	void Show();
+	int UpdateView(const Position& eye); //casts the view of a dark room from eye if it moved or a wall in reach changed, redraws the cells that appeared or disappeared, returns how many
+	const FieldOfView& GetView() const;
+	int UpdateFlowField(const Position& target); //distances of the room to target, searched in full the first time, after that only cells target or wall changes move are written, returns how many
+	const FlowField& GetFlowField() const; //NextStep of a follower
 	void SetCharacterAt(const Position& position, const char& character); //sets original character at position to given character
 	void RemoveOptionAt(const Position& postiion, const OPTION& optionName); //removes an option with given option name from original map at given position
+	void SetCollidableAt(const Position& position, const bool& collidable); //adds or removes COLLIDABLE in original map and updates collision data
 	void SetTileColorAt(const Position& position, const int& color);
 	void SetTileBackgroundColorAt(const Position& position, const int& color);
+	void ApplyEdit(const MapEdit& edit); //repeats an edit through its setter
+	int EditsNumber() const;
+	const MapEdit& GetEdit(const int& index) const;
+	bool HasEdits(const std::vector<MapEdit>& edits) const; //true if exactly these edits were made since the map was loaded
+	void AdvanceTimers(std::vector<Position>& changedPositions); //one tick: toggles and redraws the timed tiles due in it, changedPositions gets them
+	void SetTicks(const int& ticks, std::vector<Position>& changedPositions); //puts every timed tile in its state after ticks (rewind), redraws the ones that change
+	int GetTicks() const; //ticks since the map was loaded
+	int TimedTilesNumber() const;
+	void TriggersAt(const Position& position, int& first, int& number) const; //none outside the map
+	const Trigger& GetTrigger(const int& index) const;
+	const TriggerOp& GetTriggerOp(const int& index) const;
 };
 
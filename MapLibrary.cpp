@@ -0,0 +1,48 @@
+#include "MapLibrary.h"
+
+std::shared_ptr<const Map> MapLibrary::Get(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	std::unordered_map<std::string, std::shared_ptr<const Map>>::const_iterator map = _maps.find(filename);
+	if (map != _maps.end())
+	{
+		return map->second;
+	}
+
+	std::ifstream mapStream(filename);
+
+	if (!mapStream.good())
+	{
+		throw new Exception(1, "[MAP] file open error.");
+	}
+
+	//prototypes outlive the level asking for them, so they never come from its arena
+	ArenaScope scope(nullptr);
+	std::shared_ptr<const Map> parsedMap = std::make_shared<const Map>(mapStream);
+	mapStream.close();
+
+	_maps[filename] = parsedMap;
+	return parsedMap;
+}
+
+void MapLibrary::Forget(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_maps.erase(filename);
+}
+
+void MapLibrary::Add(const std::string& name, std::istream& mapStream)
+{
+	ArenaScope scope(nullptr);
+	std::shared_ptr<const Map> parsedMap = std::make_shared<const Map>(mapStream);
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_maps[name] = parsedMap;
+}
+
+int MapLibrary::Size()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return static_cast<int>(_maps.size());
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <fstream>
+#include "Map.h"
+#include "Exception.h"
+
+// parsed maps shared by every level that uses them - each .map file is parsed once, levels copy the prototype
+
+class MapLibrary
+{
+private:
+	std::unordered_map<std::string, std::shared_ptr<const Map>> _maps;
+	std::mutex _mutex;
+
+public:
+	std::shared_ptr<const Map> Get(const std::string& filename); //parses the file on the first request, safe to call from many threads
+	void Forget(const std::string& filename); //the file changed - it is parsed again on the next request
+	void Add(const std::string& name, std::istream& mapStream); //a map without a file (e.g. generated), levels name it as if it were one
+	int Size();
+};
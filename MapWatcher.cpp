@@ -0,0 +1,97 @@
+#include "MapWatcher.h"
+
+MapWatcher::MapWatcher() {}
+
+MapWatcher::~MapWatcher()
+{
+	Close();
+}
+
+void MapWatcher::Close()
+{
+	for (Directory& directory : _directories)
+	{
+		if (directory.handle != INVALID_HANDLE_VALUE)
+		{
+			FindCloseChangeNotification(directory.handle);
+		}
+	}
+
+	_directories = {};
+	_contents = {};
+}
+
+std::string MapWatcher::DirectoryOf(const std::string& filename)
+{
+	size_t separator = filename.find_last_of("/\\");
+	return separator == std::string::npos ? "." : filename.substr(0, separator);
+}
+
+std::string MapWatcher::Read(const std::string& filename)
+{
+	std::ifstream fileStream(filename);
+	std::stringstream text;
+	text << fileStream.rdbuf();
+	return text.str();
+}
+
+void MapWatcher::Watch(const std::vector<std::string>& filenames)
+{
+	Close();
+
+	for (const std::string& filename : filenames)
+	{
+		_contents[filename] = Read(filename);
+
+		std::string path = DirectoryOf(filename);
+		bool watched = false;
+		for (const Directory& directory : _directories)
+		{
+			if (directory.path == path)
+			{
+				watched = true;
+				break;
+			}
+		}
+
+		if (!watched)
+		{
+			//editors often save through a temporary file and a rename, so names are watched too
+			HANDLE handle = FindFirstChangeNotificationA(path.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+			_directories.push_back({ path, handle });
+		}
+	}
+}
+
+std::vector<std::string> MapWatcher::ChangedFiles()
+{
+	std::vector<std::string> changedFiles;
+
+	for (Directory& directory : _directories)
+	{
+		if (directory.handle == INVALID_HANDLE_VALUE or WaitForSingleObject(directory.handle, 0) != WAIT_OBJECT_0)
+		{
+			continue;
+		}
+
+		FindNextChangeNotification(directory.handle);
+
+		//the notification only names the directory - the files in it are compared with their last text
+		for (std::pair<const std::string, std::string>& file : _contents)
+		{
+			if (DirectoryOf(file.first) != directory.path)
+			{
+				continue;
+			}
+
+			std::string text = Read(file.first);
+			if (text != file.second)
+			{
+				file.second = text;
+				changedFiles.push_back(file.first);
+			}
+		}
+	}
+
+	return changedFiles;
+}
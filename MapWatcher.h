@@ -0,0 +1,32 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <Windows.h>
+
+// watches the map files of the current level for edits (directory change notifications), never blocks the game loop
+
+class MapWatcher
+{
+private:
+	struct Directory
+	{
+		std::string path;
+		HANDLE handle; //change notification, INVALID_HANDLE_VALUE - not watched
+	};
+
+	std::vector<Directory> _directories;
+	std::unordered_map<std::string, std::string> _contents; //watched file -> its text when it was last seen
+
+	static std::string DirectoryOf(const std::string& filename);
+	static std::string Read(const std::string& filename);
+	void Close();
+
+public:
+	MapWatcher();
+	~MapWatcher();
+	void Watch(const std::vector<std::string>& filenames); //replaces the watched files
+	std::vector<std::string> ChangedFiles(); //files whose text changed since the last call, empty if no directory was signalled
+};
@@ -0,0 +1,162 @@
+#include "MemoryStats.h"
+
+thread_local MemoryStats::Pending MemoryStats::pending = {};
+thread_local MemoryStats::ThreadExit MemoryStats::threadExit;
+std::atomic<long long> MemoryStats::liveBytes[static_cast<int>(MEMORY_TAG::COUNT)] = {};
+std::atomic<long long> MemoryStats::peakBytes[static_cast<int>(MEMORY_TAG::COUNT)] = {};
+std::atomic<long long> MemoryStats::allocations[static_cast<int>(MEMORY_TAG::COUNT)] = {};
+std::atomic<long long> MemoryStats::heapAllocations(0);
+
+//counted for --restarts, the rest is what the default ones do
+void* operator new(std::size_t size)
+{
+	MemoryStats::heapAllocations.fetch_add(1, std::memory_order_relaxed);
+	void* block = std::malloc(size > 0 ? size : 1);
+
+	if (block == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return block;
+}
+
+void operator delete(void* block) noexcept
+{
+	std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+	std::free(block);
+}
+
+MemoryStats::ThreadExit::~ThreadExit()
+{
+	FlushThread();
+}
+
+void MemoryStats::Flush(const int& index)
+{
+	threadExit.armed = true;
+	long long live = liveBytes[index] += pending.bytes[index];
+	allocations[index] += pending.allocations[index];
+	pending.bytes[index] = 0;
+	pending.allocations[index] = 0;
+
+	long long peak = peakBytes[index];
+	while (live > peak and !peakBytes[index].compare_exchange_weak(peak, live))
+	{
+	}
+}
+
+void MemoryStats::FlushThread()
+{
+	for (int i = 0; i < static_cast<int>(MEMORY_TAG::COUNT); i++)
+	{
+		Flush(i);
+	}
+}
+
+long long MemoryStats::HeapAllocations()
+{
+	return heapAllocations;
+}
+
+long long MemoryStats::LiveBytes(const MEMORY_TAG& tag)
+{
+	return liveBytes[static_cast<int>(tag)];
+}
+
+long long MemoryStats::PeakBytes(const MEMORY_TAG& tag)
+{
+	return peakBytes[static_cast<int>(tag)];
+}
+
+long long MemoryStats::Allocations(const MEMORY_TAG& tag)
+{
+	return allocations[static_cast<int>(tag)];
+}
+
+std::string MemoryStats::Name(const MEMORY_TAG& tag)
+{
+	switch (tag)
+	{
+	case MEMORY_TAG::TILES:
+		return "tiles";
+
+	case MEMORY_TAG::ORIGINAL_TILES:
+		return "original tiles";
+
+	case MEMORY_TAG::OPTIONS:
+		return "options";
+
+	case MEMORY_TAG::ROW_TEXT:
+		return "row text";
+
+	case MEMORY_TAG::COLLISION:
+		return "collision";
+
+	case MEMORY_TAG::TRIGGERS:
+		return "triggers";
+
+	case MEMORY_TAG::TIMERS:
+		return "timers";
+
+	case MEMORY_TAG::VIEW:
+		return "view";
+
+	case MEMORY_TAG::FLOW:
+		return "flow field";
+
+	case MEMORY_TAG::EDITS:
+		return "edits";
+
+	default:
+		return "other";
+	}
+}
+
+std::vector<std::string> MemoryStats::Lines()
+{
+	FlushThread();
+
+	std::vector<std::string> lines;
+	long long live = 0;
+	long long peak = 0; //sum of the peaks, an upper bound of the total peak
+	long long count = 0;
+
+	for (int i = 0; i < static_cast<int>(MEMORY_TAG::COUNT); i++)
+	{
+		MEMORY_TAG tag = static_cast<MEMORY_TAG>(i);
+		if (Allocations(tag) == 0)
+		{
+			continue;
+		}
+
+		std::ostringstream line;
+		line << std::fixed << std::setprecision(1) << std::left << std::setw(15) << Name(tag) << std::right
+			<< " live " << std::setw(9) << LiveBytes(tag) / 1024.0 << " KB, peak " << std::setw(9) << PeakBytes(tag) / 1024.0
+			<< " KB, " << std::setw(9) << Allocations(tag) << " allocations";
+		lines.push_back(line.str());
+
+		live += LiveBytes(tag);
+		peak += PeakBytes(tag);
+		count += Allocations(tag);
+	}
+
+	std::ostringstream total;
+	total << std::fixed << std::setprecision(1) << std::left << std::setw(15) << "total" << std::right
+		<< " live " << std::setw(9) << live / 1024.0 << " KB, peak " << std::setw(9) << peak / 1024.0 << " KB, " << std::setw(9) << count << " allocations";
+	lines.push_back(total.str());
+	return lines;
+}
+
+void MemoryStats::Report(std::ostream& reportStream)
+{
+	reportStream << "memory by subsystem:\n";
+	for (const std::string& line : Lines())
+	{
+		reportStream << "  " << line << "\n";
+	}
+}
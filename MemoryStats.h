@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <iomanip>
+#include <sstream>
+#include <new>
+#include <cstdlib>
+
+// process-wide memory accounting of tagged allocations (ArenaAllocator), by the subsystem that asked for them
+// live bytes go down when a container frees a block, also if it came from an arena that still holds the memory
+// every thread counts on its own and adds to the totals once it is FLUSH_BYTES off, so totals and peaks of other threads
+// are exact to that much per thread, a thread's own counts are added before it reads them
+
+enum class MEMORY_TAG { OTHER = 0, TILES = 1, ORIGINAL_TILES = 2, OPTIONS = 3, ROW_TEXT = 4, COLLISION = 5, TRIGGERS = 6, TIMERS = 7, VIEW = 8, FLOW = 9, EDITS = 10, COUNT = 11 };
+
+class MemoryStats
+{
+private:
+	struct Pending //counts of one thread not added to the totals yet, plain data so counting costs no thread_local guard
+	{
+		long long bytes[static_cast<int>(MEMORY_TAG::COUNT)];
+		long long allocations[static_cast<int>(MEMORY_TAG::COUNT)];
+	};
+
+	struct ThreadExit //made by the first Flush of a thread, a thread that ends hands in what it counted
+	{
+		bool armed = false;
+		~ThreadExit();
+	};
+
+	static const long long FLUSH_BYTES = 64 * 1024;
+
+	static thread_local Pending pending;
+	static thread_local ThreadExit threadExit;
+	static std::atomic<long long> liveBytes[static_cast<int>(MEMORY_TAG::COUNT)];
+	static std::atomic<long long> peakBytes[static_cast<int>(MEMORY_TAG::COUNT)];
+	static std::atomic<long long> allocations[static_cast<int>(MEMORY_TAG::COUNT)];
+
+	static void Flush(const int& index);
+
+	friend void* ::operator new(std::size_t size);
+	static std::atomic<long long> heapAllocations; //every global operator new, tagged or not
+
+public:
+	//inline, they run for every tagged allocation
+	static void Allocated(const MEMORY_TAG& tag, const size_t& bytes)
+	{
+		int index = static_cast<int>(tag);
+		pending.allocations[index]++;
+		if ((pending.bytes[index] += static_cast<long long>(bytes)) >= FLUSH_BYTES)
+		{
+			Flush(index);
+		}
+	}
+
+	static void Freed(const MEMORY_TAG& tag, const size_t& bytes)
+	{
+		int index = static_cast<int>(tag);
+		if ((pending.bytes[index] -= static_cast<long long>(bytes)) <= -FLUSH_BYTES)
+		{
+			Flush(index);
+		}
+	}
+
+	static void FlushThread(); //adds what the calling thread counted to the totals
+	static long long LiveBytes(const MEMORY_TAG& tag);
+	static long long PeakBytes(const MEMORY_TAG& tag);
+	static long long Allocations(const MEMORY_TAG& tag); //so far, freed ones included
+	static long long HeapAllocations(); //global operator new calls of the whole process so far
+	static std::string Name(const MEMORY_TAG& tag);
+	static std::vector<std::string> Lines(); //one line per tag that was ever used and one with the totals
+	static void Report(std::ostream& reportStream);
+};
@@ -1,12 +1,13 @@
 #pragma once
 #include <vector>
+#include "Arena.h"
 
-enum class OPTION {OPTION_ERROR=-1, COLLIDABLE=0, SWITCH_MAP=1, DEAL_DMG=2, ADD_SCORE=3, EXIT_LEVEL=4};
+enum class OPTION {OPTION_ERROR=-1, COLLIDABLE=0, SWITCH_MAP=1, DEAL_DMG=2, ADD_SCORE=3, EXIT_LEVEL=4, TIMED=5};
 
 struct Option
 {
 	OPTION optionName;
-	std::vector<int> arguments;
+	std::vector<int, ArenaAllocator<int, MEMORY_TAG::OPTIONS>> arguments;
 
 	bool Good() const
 	{
@@ -25,6 +25,12 @@ int Player::Hp() const
 	return _currentHp;
 }
 
+void Player::SetHp(const int& hp)
+{
+	_currentHp = hp;
+	_dead = _currentHp <= 0;
+}
+
 void Player::Die()
 {
 	_dead = true;
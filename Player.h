@@ -20,6 +20,7 @@ public:
 	void Update();
 	int MaxHp() const;
 	int Hp() const;
+	void SetHp(const int& hp);
 	void SetDirection(const Position& direction);
 	Position GetDirection() const;
 	int GetJumpHeight() const;
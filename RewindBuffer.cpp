@@ -0,0 +1,344 @@
+#include "RewindBuffer.h"
+
+RewindBuffer::RewindBuffer(const int& capacity, const int& keyframeInterval)
+{
+	_keyframeInterval = keyframeInterval < 1 ? 1 : keyframeInterval;
+
+	//one more segment than capacity needs, so dropping the oldest still leaves capacity ticks
+	_segments = std::vector<Segment>((capacity + _keyframeInterval - 1) / _keyframeInterval + 1);
+	Clear();
+}
+
+void RewindBuffer::Record(const RewindState& state, const Map& map, const int& mapLoads)
+{
+	bool roomLoaded = _ticks == 0 or mapLoads != _lastMapLoads;
+	int firstEdit = roomLoaded ? 0 : _lastEditsNumber;
+
+	if (_segmentsNumber == 0 or static_cast<int>(SegmentAt(_segmentsNumber - 1).offsets.size()) == _keyframeInterval)
+	{
+		if (_segmentsNumber == static_cast<int>(_segments.size()))
+		{
+			_ticks -= static_cast<int>(SegmentAt(0).offsets.size());
+			_firstSegment = (_firstSegment + 1) % static_cast<int>(_segments.size());
+			_segmentsNumber--;
+		}
+
+		Segment& segment = SegmentAt(_segmentsNumber);
+		_segmentsNumber++;
+		segment.bytes.clear();
+		segment.offsets.clear();
+		segment.offsets.push_back(0);
+
+		//keyframe: every field and all edits of the room
+		WriteNumber(segment.bytes, state.mapIndex);
+		WriteNumber(segment.bytes, state.position.x);
+		WriteNumber(segment.bytes, state.position.y);
+		WriteNumber(segment.bytes, state.hp);
+		WriteNumber(segment.bytes, state.score);
+		WriteNumber(segment.bytes, Flags(state));
+		WriteNumber(segment.bytes, state.roomTicks);
+		WriteNumber(segment.bytes, map.EditsNumber());
+
+		for (int i = 0; i < map.EditsNumber(); i++)
+		{
+			WriteEdit(segment.bytes, map.GetEdit(i));
+		}
+	}
+	else
+	{
+		Segment& segment = SegmentAt(_segmentsNumber - 1);
+		segment.offsets.push_back(static_cast<int>(segment.bytes.size()));
+
+		int mask = 0;
+		mask |= state.mapIndex != _last.mapIndex ? MAP_INDEX : 0;
+		mask |= state.position.x != _last.position.x ? POSITION_X : 0;
+		mask |= state.position.y != _last.position.y ? POSITION_Y : 0;
+		mask |= state.hp != _last.hp ? HP : 0;
+		mask |= state.score != _last.score ? SCORE : 0;
+		mask |= Flags(state) != Flags(_last) ? FLAGS : 0;
+		mask |= map.EditsNumber() > firstEdit ? EDITS : 0;
+		mask |= roomLoaded ? ROOM_LOADED : 0;
+		mask |= state.roomTicks != _last.roomTicks + 1 ? ROOM_TICKS : 0;
+		WriteUnsigned(segment.bytes, mask);
+
+		if (mask & MAP_INDEX)
+		{
+			WriteNumber(segment.bytes, state.mapIndex - _last.mapIndex);
+		}
+
+		if (mask & POSITION_X)
+		{
+			WriteNumber(segment.bytes, state.position.x - _last.position.x);
+		}
+
+		if (mask & POSITION_Y)
+		{
+			WriteNumber(segment.bytes, state.position.y - _last.position.y);
+		}
+
+		if (mask & HP)
+		{
+			WriteNumber(segment.bytes, state.hp - _last.hp);
+		}
+
+		if (mask & SCORE)
+		{
+			WriteNumber(segment.bytes, state.score - _last.score);
+		}
+
+		if (mask & FLAGS)
+		{
+			WriteNumber(segment.bytes, Flags(state));
+		}
+
+		if (mask & ROOM_TICKS)
+		{
+			WriteNumber(segment.bytes, state.roomTicks);
+		}
+
+		if (mask & EDITS)
+		{
+			WriteNumber(segment.bytes, map.EditsNumber() - firstEdit);
+
+			for (int i = firstEdit; i < map.EditsNumber(); i++)
+			{
+				WriteEdit(segment.bytes, map.GetEdit(i));
+			}
+		}
+	}
+
+	_last = state;
+	_lastEditsNumber = map.EditsNumber();
+	_lastMapLoads = mapLoads;
+	_ticks++;
+}
+
+bool RewindBuffer::Restore(const int& ticksBack, RewindState& state, std::vector<MapEdit>& edits) const
+{
+	if (ticksBack < 0 or ticksBack >= _ticks)
+	{
+		return false;
+	}
+
+	//only the newest segment can be partly filled, so the record's segment follows from its index
+	int index = _ticks - 1 - ticksBack;
+	const Segment& segment = SegmentAt(index / _keyframeInterval);
+	int record = index % _keyframeInterval;
+	int offset = 0;
+
+	state.mapIndex = ReadNumber(segment.bytes, offset);
+	state.position.x = ReadNumber(segment.bytes, offset);
+	state.position.y = ReadNumber(segment.bytes, offset);
+	state.hp = ReadNumber(segment.bytes, offset);
+	state.score = ReadNumber(segment.bytes, offset);
+	SetFlags(state, ReadNumber(segment.bytes, offset));
+	state.roomTicks = ReadNumber(segment.bytes, offset);
+
+	edits.clear();
+	int editsNumber = ReadNumber(segment.bytes, offset);
+	for (int i = 0; i < editsNumber; i++)
+	{
+		edits.push_back(ReadEdit(segment.bytes, offset));
+	}
+
+	for (int i = 1; i <= record; i++)
+	{
+		unsigned int mask = ReadUnsigned(segment.bytes, offset);
+		state.roomTicks++;
+
+		if (mask & MAP_INDEX)
+		{
+			state.mapIndex += ReadNumber(segment.bytes, offset);
+		}
+
+		if (mask & POSITION_X)
+		{
+			state.position.x += ReadNumber(segment.bytes, offset);
+		}
+
+		if (mask & POSITION_Y)
+		{
+			state.position.y += ReadNumber(segment.bytes, offset);
+		}
+
+		if (mask & HP)
+		{
+			state.hp += ReadNumber(segment.bytes, offset);
+		}
+
+		if (mask & SCORE)
+		{
+			state.score += ReadNumber(segment.bytes, offset);
+		}
+
+		if (mask & FLAGS)
+		{
+			SetFlags(state, ReadNumber(segment.bytes, offset));
+		}
+
+		if (mask & ROOM_TICKS)
+		{
+			state.roomTicks = ReadNumber(segment.bytes, offset);
+		}
+
+		if (mask & ROOM_LOADED)
+		{
+			edits.clear();
+		}
+
+		if (mask & EDITS)
+		{
+			editsNumber = ReadNumber(segment.bytes, offset);
+			for (int j = 0; j < editsNumber; j++)
+			{
+				edits.push_back(ReadEdit(segment.bytes, offset));
+			}
+		}
+	}
+
+	return true;
+}
+
+bool RewindBuffer::Rewind(const int& ticksBack, RewindState& state, std::vector<MapEdit>& edits)
+{
+	if (!Restore(ticksBack, state, edits))
+	{
+		return false;
+	}
+
+	for (int i = 0; i < ticksBack; i++)
+	{
+		Segment& segment = SegmentAt(_segmentsNumber - 1);
+		segment.bytes.resize(segment.offsets.back());
+		segment.offsets.pop_back();
+
+		if (segment.offsets.empty())
+		{
+			_segmentsNumber--;
+		}
+	}
+
+	_ticks -= ticksBack;
+	_last = state;
+	_lastEditsNumber = static_cast<int>(edits.size());
+	return true;
+}
+
+void RewindBuffer::Clear()
+{
+	_firstSegment = 0;
+	_segmentsNumber = 0;
+	_ticks = 0;
+	_last = {};
+	_lastEditsNumber = 0;
+	_lastMapLoads = 0;
+}
+
+int RewindBuffer::Ticks() const
+{
+	return _ticks;
+}
+
+size_t RewindBuffer::Bytes() const
+{
+	size_t bytes = 0;
+	for (int i = 0; i < _segmentsNumber; i++)
+	{
+		bytes += SegmentAt(i).bytes.size() + SegmentAt(i).offsets.size() * sizeof(int);
+	}
+
+	return bytes;
+}
+
+size_t RewindBuffer::ReservedBytes() const
+{
+	size_t bytes = _segments.size() * sizeof(Segment);
+	for (const Segment& segment : _segments)
+	{
+		bytes += segment.bytes.capacity() + segment.offsets.capacity() * sizeof(int);
+	}
+
+	return bytes;
+}
+
+void RewindBuffer::WriteNumber(std::vector<unsigned char>& bytes, const int& number)
+{
+	//small positive and negative differences both take one byte
+	WriteUnsigned(bytes, (static_cast<unsigned int>(number) << 1) ^ static_cast<unsigned int>(number >> 31));
+}
+
+int RewindBuffer::ReadNumber(const std::vector<unsigned char>& bytes, int& offset)
+{
+	unsigned int zigzag = ReadUnsigned(bytes, offset);
+	return static_cast<int>(zigzag >> 1) ^ -static_cast<int>(zigzag & 1);
+}
+
+void RewindBuffer::WriteUnsigned(std::vector<unsigned char>& bytes, unsigned int number)
+{
+	while (number >= 0x80)
+	{
+		bytes.push_back(static_cast<unsigned char>(number | 0x80));
+		number >>= 7;
+	}
+
+	bytes.push_back(static_cast<unsigned char>(number));
+}
+
+unsigned int RewindBuffer::ReadUnsigned(const std::vector<unsigned char>& bytes, int& offset)
+{
+	unsigned int number = 0;
+	int shift = 0;
+
+	while (bytes[offset] & 0x80)
+	{
+		number |= static_cast<unsigned int>(bytes[offset] & 0x7f) << shift;
+		shift += 7;
+		offset++;
+	}
+
+	number |= static_cast<unsigned int>(bytes[offset]) << shift;
+	offset++;
+
+	return number;
+}
+
+void RewindBuffer::WriteEdit(std::vector<unsigned char>& bytes, const MapEdit& edit)
+{
+	bytes.push_back(static_cast<unsigned char>(edit.kind));
+	WriteNumber(bytes, edit.position.x);
+	WriteNumber(bytes, edit.position.y);
+	WriteNumber(bytes, edit.value);
+}
+
+MapEdit RewindBuffer::ReadEdit(const std::vector<unsigned char>& bytes, int& offset)
+{
+	MapEdit edit;
+	edit.kind = static_cast<MAP_EDIT>(bytes[offset]);
+	offset++;
+	edit.position.x = ReadNumber(bytes, offset);
+	edit.position.y = ReadNumber(bytes, offset);
+	edit.value = ReadNumber(bytes, offset);
+	return edit;
+}
+
+int RewindBuffer::Flags(const RewindState& state)
+{
+	return state.jumpingFrame * 4 + (state.jumping ? 2 : 0) + (state.ended ? 1 : 0);
+}
+
+void RewindBuffer::SetFlags(RewindState& state, const int& flags)
+{
+	state.jumpingFrame = flags / 4;
+	state.jumping = (flags & 2) != 0;
+	state.ended = (flags & 1) != 0;
+}
+
+RewindBuffer::Segment& RewindBuffer::SegmentAt(const int& index)
+{
+	return _segments[(_firstSegment + index) % _segments.size()];
+}
+
+const RewindBuffer::Segment& RewindBuffer::SegmentAt(const int& index) const
+{
+	return _segments[(_firstSegment + index) % _segments.size()];
+}
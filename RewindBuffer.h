@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include "Map.h"
+#include "Position.h"
+
+// last ticks of a level for rewinding: every tick is recorded as a delta against the tick before,
+// every keyframeInterval-th tick as a keyframe that also holds all edits of the room loaded at that time
+// records are kept in a ring of segments (one keyframe and its deltas), the oldest segment is dropped whole
+
+struct RewindState
+{
+	int mapIndex;
+	Position position; //top left of the player
+	int hp;
+	int score;
+	bool jumping;
+	int jumpingFrame;
+	bool ended;
+	int roomTicks; //Map::GetTicks(), timed tiles follow from it
+};
+
+class RewindBuffer
+{
+private:
+	struct Segment
+	{
+		std::vector<unsigned char> bytes;
+		std::vector<int> offsets; //where every tick's record starts in bytes
+	};
+
+	//delta record: mask (varint, one byte unless the room changed) followed by the differences of the fields set in it
+	static const int MAP_INDEX = 1;
+	static const int POSITION_X = 2;
+	static const int POSITION_Y = 4;
+	static const int HP = 8;
+	static const int SCORE = 16;
+	static const int FLAGS = 32; //jumping frame, jumping and ended packed into one number
+	static const int EDITS = 64; //new edits of the room follow the fields
+	static const int ROOM_LOADED = 128; //the room was loaded again, its edit list starts empty
+	static const int ROOM_TICKS = 256; //the room's clock did not advance by exactly one tick
+
+	std::vector<Segment> _segments; //ring, segments are cleared and reused instead of freed
+	int _firstSegment;
+	int _segmentsNumber;
+	int _keyframeInterval;
+	int _ticks;
+	RewindState _last; //state of the newest record
+	int _lastEditsNumber; //edits of the room in the newest record
+	int _lastMapLoads;
+
+	static void WriteNumber(std::vector<unsigned char>& bytes, const int& number); //zigzag varint
+	static int ReadNumber(const std::vector<unsigned char>& bytes, int& offset);
+	static void WriteUnsigned(std::vector<unsigned char>& bytes, unsigned int number); //varint
+	static unsigned int ReadUnsigned(const std::vector<unsigned char>& bytes, int& offset);
+	static void WriteEdit(std::vector<unsigned char>& bytes, const MapEdit& edit);
+	static MapEdit ReadEdit(const std::vector<unsigned char>& bytes, int& offset);
+	static int Flags(const RewindState& state);
+	static void SetFlags(RewindState& state, const int& flags);
+	Segment& SegmentAt(const int& index); //index from the oldest segment
+	const Segment& SegmentAt(const int& index) const;
+
+public:
+	RewindBuffer(const int& capacity, const int& keyframeInterval = 60); //keeps at least capacity ticks
+	void Record(const RewindState& state, const Map& map, const int& mapLoads); //mapLoads - Level::GetMapLoads(), a new number means the room was loaded again
+	bool Restore(const int& ticksBack, RewindState& state, std::vector<MapEdit>& edits) const; //0 - newest record, false if not recorded that far
+	bool Rewind(const int& ticksBack, RewindState& state, std::vector<MapEdit>& edits); //Restore, then forgets the newer ticks so the restored one is the newest
+	void Clear();
+	int Ticks() const;
+	size_t Bytes() const; //size of the encoded records
+	size_t ReservedBytes() const; //memory held by the ring
+};
@@ -0,0 +1,430 @@
+#include "Screen.h"
+
+Screen::Screen()
+{
+	_bytesWritten = 0;
+	_writeNanoseconds = 0;
+}
+
+Screen::~Screen() {}
+
+void Screen::WriteBytes(const char* bytes, const size_t& length)
+{
+	Write(std::string(bytes, length));
+}
+
+void Screen::Flush() {}
+
+void Screen::Sync()
+{
+	Flush();
+}
+
+long long Screen::BytesWritten() const
+{
+	return _bytesWritten;
+}
+
+long long Screen::WriteNanoseconds() const
+{
+	return _writeNanoseconds;
+}
+
+ConsoleScreen::ConsoleScreen()
+{
+	HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+	DWORD mode = 0;
+	if (GetConsoleMode(output, &mode))
+	{
+		SetConsoleMode(output, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+	}
+}
+
+ConsoleScreen::~ConsoleScreen() {}
+
+void ConsoleScreen::Clear()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	system("cls");
+	_writeNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ConsoleScreen::GotoPosition(const Position& position)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	COORD coord = { static_cast<short>(position.x), static_cast<short>(position.y) };
+	SetConsoleCursorPosition(GetStdHandle(STD_OUTPUT_HANDLE), coord);
+	_writeNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ConsoleScreen::Write(const std::string& text)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::cout << text;
+	_bytesWritten += static_cast<long long>(text.size());
+	_writeNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ConsoleScreen::WriteBytes(const char* bytes, const size_t& length)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::cout.write(bytes, static_cast<std::streamsize>(length));
+	_bytesWritten += static_cast<long long>(length);
+	_writeNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ConsoleScreen::Flush()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::cout.flush();
+	_writeNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+SlowScreen::SlowScreen(Screen* screen, const double& nanosecondsPerByte)
+{
+	_screen = screen;
+	_nanosecondsPerByte = nanosecondsPerByte;
+	_owedNanoseconds = 0;
+}
+
+SlowScreen::~SlowScreen()
+{
+	delete _screen;
+}
+
+void SlowScreen::Delay(const long long& bytes)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	_owedNanoseconds += static_cast<long long>(bytes * _nanosecondsPerByte);
+
+	if (_owedNanoseconds >= 1000000)
+	{
+		std::this_thread::sleep_for(std::chrono::nanoseconds(_owedNanoseconds));
+		_owedNanoseconds -= std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	_writeNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void SlowScreen::Clear()
+{
+	_screen->Clear();
+	Delay(8); //escape sequence of a terminal clear
+}
+
+void SlowScreen::GotoPosition(const Position& position)
+{
+	_screen->GotoPosition(position);
+	Delay(8); //cursor position sequence
+}
+
+void SlowScreen::Write(const std::string& text)
+{
+	_screen->Write(text);
+	_bytesWritten += static_cast<long long>(text.size());
+	Delay(static_cast<long long>(text.size()));
+}
+
+void SlowScreen::WriteBytes(const char* bytes, const size_t& length)
+{
+	_screen->WriteBytes(bytes, length);
+	_bytesWritten += static_cast<long long>(length);
+	Delay(static_cast<long long>(length));
+}
+
+void SlowScreen::Flush()
+{
+	_screen->Flush();
+}
+
+NullScreen::NullScreen() {}
+
+NullScreen::~NullScreen() {}
+
+void NullScreen::Clear() {}
+
+void NullScreen::GotoPosition(const Position& position) {}
+
+void NullScreen::Write(const std::string& text)
+{
+	_bytesWritten += static_cast<long long>(text.size());
+}
+
+void NullScreen::WriteBytes(const char* bytes, const size_t& length)
+{
+	_bytesWritten += static_cast<long long>(length);
+}
+
+AnsiScreen::AnsiScreen() {}
+
+AnsiScreen::~AnsiScreen() {}
+
+void AnsiScreen::Clear()
+{
+	Write("\u001b[0m\u001b[2J\u001b[H");
+}
+
+void AnsiScreen::GotoPosition(const Position& position)
+{
+	//terminal rows and columns start at 1
+	Write("\u001b[" + std::to_string(position.y + 1) + ";" + std::to_string(position.x + 1) + "H");
+}
+
+void AnsiScreen::Write(const std::string& text)
+{
+	_text += text;
+	_bytesWritten += static_cast<long long>(text.size());
+}
+
+void AnsiScreen::WriteBytes(const char* bytes, const size_t& length)
+{
+	_text.append(bytes, length);
+	_bytesWritten += static_cast<long long>(length);
+}
+
+std::string AnsiScreen::TakeText()
+{
+	std::string text;
+	text.swap(_text);
+	return text;
+}
+
+HashScreen::HashScreen()
+{
+	_hash = FNV_OFFSET;
+	_frameStart = 0;
+}
+
+HashScreen::~HashScreen() {}
+
+void HashScreen::Add(const char* bytes, const size_t& length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		_hash = (_hash ^ static_cast<unsigned char>(bytes[i])) * FNV_PRIME;
+	}
+
+	_bytesWritten += static_cast<long long>(length);
+}
+
+void HashScreen::Clear()
+{
+	Write("\u001b[0m\u001b[2J\u001b[H");
+}
+
+void HashScreen::GotoPosition(const Position& position)
+{
+	//the same sequence AnsiScreen writes
+	Write("\u001b[" + std::to_string(position.y + 1) + ";" + std::to_string(position.x + 1) + "H");
+}
+
+void HashScreen::Write(const std::string& text)
+{
+	Add(text.data(), text.size());
+}
+
+void HashScreen::WriteBytes(const char* bytes, const size_t& length)
+{
+	Add(bytes, length);
+}
+
+void HashScreen::Flush()
+{
+	_frameHashes.push_back(_hash);
+	_frameBytes.push_back(_bytesWritten - _frameStart);
+	_hash = FNV_OFFSET;
+	_frameStart = _bytesWritten;
+}
+
+const std::vector<unsigned long long>& HashScreen::FrameHashes() const
+{
+	return _frameHashes;
+}
+
+const std::vector<long long>& HashScreen::FrameBytes() const
+{
+	return _frameBytes;
+}
+
+ProbeScreen::ProbeScreen()
+{
+	_cursor = { 0,0 };
+	_found = { -1,-1 };
+	_moves = 0;
+	_movedAt = 0;
+}
+
+ProbeScreen::~ProbeScreen() {}
+
+void ProbeScreen::Clear()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_rows.clear();
+	_cursor = { 0,0 };
+}
+
+void ProbeScreen::GotoPosition(const Position& position)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_cursor = position;
+}
+
+void ProbeScreen::Write(const std::string& text)
+{
+	WriteBytes(text.data(), text.size());
+}
+
+void ProbeScreen::WriteBytes(const char* bytes, const size_t& length)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	Put(bytes, length);
+	_bytesWritten += static_cast<long long>(length);
+}
+
+void ProbeScreen::Put(const char* bytes, const size_t& length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		char character = bytes[i];
+
+		if (!_sequence.empty())
+		{
+			//"ESC[" parameters and one final letter
+			_sequence += character;
+			if (_sequence.size() > 2 and character >= '@' and character <= '~')
+			{
+				Apply(_sequence);
+				_sequence.clear();
+			}
+		}
+		else if (character == '\u001b')
+		{
+			_sequence = character;
+		}
+		else if (character == '\n')
+		{
+			_cursor = { 0, _cursor.y + 1 };
+		}
+		else
+		{
+			if (_cursor.x >= 0 and _cursor.y >= 0)
+			{
+				if (_cursor.y >= static_cast<int>(_rows.size()))
+				{
+					_rows.resize(_cursor.y + 1);
+				}
+
+				if (_cursor.x >= static_cast<int>(_rows[_cursor.y].size()))
+				{
+					_rows[_cursor.y].resize(_cursor.x + 1, ' ');
+				}
+
+				_rows[_cursor.y][_cursor.x] = character;
+			}
+
+			_cursor.x++;
+		}
+	}
+}
+
+void ProbeScreen::Apply(const std::string& sequence)
+{
+	std::string parameters = sequence.substr(2, sequence.size() - 3);
+
+	switch (sequence.back())
+	{
+	case 'H':
+	{
+		//terminal rows and columns start at 1, missing ones are 1
+		size_t separator = parameters.find(';');
+		int row = std::atoi(parameters.substr(0, separator).c_str());
+		int column = separator == std::string::npos ? 1 : std::atoi(parameters.substr(separator + 1).c_str());
+		_cursor = { column > 1 ? column - 1 : 0, row > 1 ? row - 1 : 0 };
+		break;
+	}
+
+	case 'J':
+		if (parameters == "2")
+		{
+			_rows.clear();
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+Position ProbeScreen::Find() const
+{
+	if (_pattern.empty())
+	{
+		return { -1,-1 };
+	}
+
+	for (int y = 0; y < static_cast<int>(_rows.size()); y++)
+	{
+		for (int x = 0; x < static_cast<int>(_rows[y].size()); x++)
+		{
+			bool matches = true;
+			for (const std::pair<Position, char>& cell : _pattern)
+			{
+				int row = y + cell.first.y;
+				int column = x + cell.first.x;
+				if (row < 0 or row >= static_cast<int>(_rows.size()) or column < 0 or column >= static_cast<int>(_rows[row].size()) or _rows[row][column] != cell.second)
+				{
+					matches = false;
+					break;
+				}
+			}
+
+			if (matches)
+			{
+				return { x, y };
+			}
+		}
+	}
+
+	return { -1,-1 };
+}
+
+void ProbeScreen::Flush()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	Position found = Find();
+	if (found.x < 0 or found == _found)
+	{
+		return;
+	}
+
+	//the first sighting is where the pattern starts, not a move
+	if (_found.x >= 0)
+	{
+		_movedAt = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		_moves++;
+	}
+
+	_found = found;
+}
+
+void ProbeScreen::Watch(const std::vector<std::pair<Position, char>>& pattern)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_pattern.clear();
+	for (const std::pair<Position, char>& cell : pattern)
+	{
+		_pattern.push_back({ { cell.first.x - pattern[0].first.x, cell.first.y - pattern[0].first.y }, cell.second });
+	}
+
+	_found = Find();
+}
+
+long long ProbeScreen::Moves() const
+{
+	return _moves;
+}
+
+long long ProbeScreen::MovedAt() const
+{
+	return _movedAt;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include <Windows.h>
+#include "Position.h"
+
+// output backend used by Map and the HUD
+// every backend counts the bytes it was given and the time spent writing them, so the game can pace its output
+
+class Screen
+{
+protected:
+	long long _bytesWritten;
+	long long _writeNanoseconds;
+
+public:
+	Screen();
+	virtual ~Screen();
+	virtual void Clear() = 0;
+	virtual void GotoPosition(const Position& position) = 0;
+	virtual void Write(const std::string& text) = 0;
+	virtual void WriteBytes(const char* bytes, const size_t& length); //encoded output that may hold cursor moves, written as it is
+	virtual void Flush(); //pushes buffered output to the terminal, called once per frame
+	virtual void Sync(); //returns when everything written so far is on the terminal
+	virtual long long BytesWritten() const;
+	virtual long long WriteNanoseconds() const;
+};
+
+class ConsoleScreen : public Screen
+{
+public:
+	ConsoleScreen(); //turns on escape sequences, colors and cursor moves are written in-band
+	virtual ~ConsoleScreen();
+	void Clear() override;
+	void GotoPosition(const Position& position) override;
+	void Write(const std::string& text) override;
+	void WriteBytes(const char* bytes, const size_t& length) override;
+	void Flush() override;
+};
+
+class SlowScreen : public Screen //slow terminal stand-in: passes output on and then sleeps for every byte
+{
+private:
+	Screen* _screen = nullptr; //owned
+	double _nanosecondsPerByte;
+	long long _owedNanoseconds; //sleeping is coarse, short delays are added up first
+
+	void Delay(const long long& bytes);
+
+public:
+	SlowScreen(Screen* screen, const double& nanosecondsPerByte);
+	virtual ~SlowScreen();
+	void Clear() override;
+	void GotoPosition(const Position& position) override;
+	void Write(const std::string& text) override;
+	void WriteBytes(const char* bytes, const size_t& length) override;
+	void Flush() override;
+};
+
+class NullScreen : public Screen //headless renderer: drops the output, only counts it
+{
+public:
+	NullScreen();
+	virtual ~NullScreen();
+	void Clear() override;
+	void GotoPosition(const Position& position) override;
+	void Write(const std::string& text) override;
+	void WriteBytes(const char* bytes, const size_t& length) override;
+};
+
+class AnsiScreen : public Screen //keeps the output as ANSI escape sequences in a string, for terminals other than the console
+{
+private:
+	std::string _text;
+
+public:
+	AnsiScreen();
+	virtual ~AnsiScreen();
+	void Clear() override;
+	void GotoPosition(const Position& position) override;
+	void Write(const std::string& text) override;
+	void WriteBytes(const char* bytes, const size_t& length) override;
+	std::string TakeText(); //everything written since the last call
+};
+
+class HashScreen : public Screen //headless renderer for checked runs: drops the output, keeps a checksum and the size of every frame (the bytes up to a Flush)
+{
+private:
+	unsigned long long _hash; //FNV-1a of the frame so far, cursor moves and clears hashed as their escape sequences
+	long long _frameStart; //_bytesWritten when the frame started
+	std::vector<unsigned long long> _frameHashes;
+	std::vector<long long> _frameBytes;
+
+	static const unsigned long long FNV_OFFSET = 14695981039346656037ull;
+	static const unsigned long long FNV_PRIME = 1099511628211ull;
+
+	void Add(const char* bytes, const size_t& length);
+
+public:
+	HashScreen();
+	virtual ~HashScreen();
+	void Clear() override;
+	void GotoPosition(const Position& position) override;
+	void Write(const std::string& text) override;
+	void WriteBytes(const char* bytes, const size_t& length) override;
+	void Flush() override; //ends the frame
+	const std::vector<unsigned long long>& FrameHashes() const;
+	const std::vector<long long>& FrameBytes() const;
+};
+
+class ProbeScreen : public Screen //headless terminal for latency runs: keeps the glyph of every cell, at every Flush looks for a pattern of glyphs and stamps when it moved
+{
+private:
+	std::vector<std::string> _rows; //glyphs as the terminal shows them
+	Position _cursor;
+	std::string _sequence; //escape sequence not finished yet, a write may end in the middle of one
+	std::vector<std::pair<Position, char>> _pattern; //glyph of every cell, positions relative to the first one
+	Position _found; //where the first glyph of the pattern was at the last Flush, {-1, -1} - not seen yet
+	std::atomic<long long> _moves;
+	std::atomic<long long> _movedAt; //steady clock nanoseconds of the Flush of the last move
+	std::mutex _mutex; //the pattern is set by the thread that measures, output comes from the one that renders
+
+	void Put(const char* bytes, const size_t& length);
+	void Apply(const std::string& sequence); //cursor moves and clears, colors are ignored
+	Position Find() const;
+
+public:
+	ProbeScreen();
+	virtual ~ProbeScreen();
+	void Clear() override;
+	void GotoPosition(const Position& position) override;
+	void Write(const std::string& text) override;
+	void WriteBytes(const char* bytes, const size_t& length) override;
+	void Flush() override; //the output so far is on the terminal
+	void Watch(const std::vector<std::pair<Position, char>>& pattern); //glyphs at their positions, only the offsets between them matter
+	long long Moves() const; //times the pattern was found somewhere else than at the Flush before
+	long long MovedAt() const;
+};
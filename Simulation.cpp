@@ -0,0 +1,1324 @@
+#include "Simulation.h"
+
+Simulation::Simulation(const std::vector<std::string>& levels, const int& sessions, const int& ticksPerSession, const int& threads, const std::string& scriptFilename)
+{
+	_levels = levels;
+	_sessionsNumber = sessions;
+	_ticksPerSession = ticksPerSession;
+	_threads = threads;
+	_ticks = 0;
+	_restarts = 0;
+	_failedSessions = 0;
+
+	if (!scriptFilename.empty())
+	{
+		std::ifstream scriptStream(scriptFilename);
+
+		if (!scriptStream.good())
+		{
+			throw new Exception(1, "[SIMULATION] input script open error.");
+		}
+
+		std::stringstream script;
+		script << scriptStream.rdbuf();
+		_script = script.str();
+		scriptStream.close();
+	}
+}
+
+void Simulation::Run(std::ostream& reportStream)
+{
+	const int sliceTicks = 256;
+	Sound::muted = true;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int threads;
+	long long steals;
+
+	{
+		WorkStealingPool pool(_threads);
+
+		for (int i = 0; i < _sessionsNumber; i++)
+		{
+			std::shared_ptr<Session> session = std::make_shared<Session>();
+			session->index = i;
+			session->ticksLeft = _ticksPerSession;
+			session->restarts = 0;
+
+			pool.Submit([this, &pool, session, sliceTicks]() { RunSlice(pool, session, sliceTicks); });
+		}
+
+		pool.Wait();
+		threads = pool.Threads();
+		steals = pool.Steals();
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	reportStream << std::fixed << std::setprecision(2);
+	reportStream << "sessions: " << _sessionsNumber << " (" << _failedSessions << " failed), threads: " << threads << ", steals: " << steals << "\n";
+	reportStream << "maps parsed: " << _mapLibrary.Size() << ", level restarts: " << _restarts << "\n";
+	reportStream << "ticks: " << _ticks << " in " << seconds << " s - " << (seconds > 0.0 ? _ticks / seconds : 0.0) << " ticks/s\n";
+	reportStream << "tick latency [us]: mean " << _tickLatency.Mean() / 1000.0 << ", p50 " << _tickLatency.Percentile(50) / 1000.0 << ", p99 " << _tickLatency.Percentile(99) / 1000.0 << ", max " << _tickLatency.Max() / 1000.0 << "\n";
+	reportStream << "session p99 tick latency [us]: median " << _sessionP99.Percentile(50) / 1000.0 << ", worst " << _sessionP99.Max() / 1000.0 << "\n";
+}
+
+void Simulation::RunRestarts(std::ostream& reportStream, const int& restarts)
+{
+	Sound::muted = true;
+
+	Game game(_levels, new NullScreen(), new RandomInput(1), &_mapLibrary);
+	game.StartLevel(0); //maps are parsed here, restarts only copy them
+
+	size_t workingSetBefore = WorkingSet();
+	long long chunksBefore = Arena::ChunksAllocated();
+	long long allocationsBefore = Arena::ArenaAllocations();
+	long long heapAllocationsBefore = MemoryStats::HeapAllocations();
+	LatencyHistogram loadTime;
+
+	for (int i = 0; i < restarts; i++)
+	{
+		std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+		game.StartLevel(i % static_cast<int>(_levels.size()));
+		loadTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - loadStart).count());
+	}
+
+	size_t workingSetAfter = WorkingSet();
+	double perRestart = restarts > 0 ? 1.0 / restarts : 0.0;
+
+	reportStream << std::fixed << std::setprecision(2);
+	reportStream << "restarts: " << restarts << ", load time [us]: mean " << loadTime.Mean() / 1000.0 << ", p50 " << loadTime.Percentile(50) / 1000.0 << ", p99 " << loadTime.Percentile(99) / 1000.0 << ", max " << loadTime.Max() / 1000.0 << "\n";
+	reportStream << "per restart: " << (Arena::ArenaAllocations() - allocationsBefore) * perRestart << " arena allocations in " << (Arena::ChunksAllocated() - chunksBefore) * perRestart << " heap chunks, "
+		<< (MemoryStats::HeapAllocations() - heapAllocationsBefore) * perRestart << " heap allocations in all (arena chunks and everything else)\n";
+	reportStream << "working set [KB]: before " << workingSetBefore / 1024 << ", after " << workingSetAfter / 1024 << "\n";
+	reportStream << "tile: " << sizeof(EntityTile) << " bytes, " << 2 * sizeof(std::string) << " of them color strings\n";
+	MemoryStats::Report(reportStream); //the level left loaded and the maps of the library
+}
+
+void Simulation::RunRewind(std::ostream& reportStream, const int& seconds, const int& ticksPerSecond)
+{
+	Sound::muted = true;
+	int capacity = seconds * ticksPerSecond;
+
+	Game game(_levels, new NullScreen(), new RandomInput(1), &_mapLibrary);
+	game.StartLevel(0);
+	game.SetRewindTicks(capacity);
+	const RewindBuffer* buffer = game.GetRewindBuffer();
+
+	//the ring is filled twice, a level that ends is rewound by a second and played on like a tester would
+	LatencyHistogram tickTime;
+	for (int i = 0; i < 2 * capacity; i++)
+	{
+		std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+		game.Tick();
+		tickTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tickStart).count());
+
+		if (game.GetLevel()->Ended() and !game.Rewind(ticksPerSecond))
+		{
+			game.RestartLevel();
+		}
+	}
+
+	//any recorded tick decoded from its keyframe
+	std::mt19937 generator(1);
+	LatencyHistogram restoreTime;
+	RewindState state;
+	std::vector<MapEdit> edits;
+
+	for (int i = 0; i < 1000; i++)
+	{
+		int ticksBack = static_cast<int>(generator() % buffer->Ticks());
+		std::chrono::steady_clock::time_point restoreStart = std::chrono::steady_clock::now();
+		buffer->Restore(ticksBack, state, edits);
+		restoreTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - restoreStart).count());
+	}
+
+	size_t bytes = buffer->Bytes();
+	size_t reservedBytes = buffer->ReservedBytes();
+	int ticks = buffer->Ticks();
+
+	//held rewind key: one tick back at a time, restored into the game (rooms loaded again where edits are undone)
+	LatencyHistogram rewindTime;
+	int mapLoads = game.GetLevel()->GetMapLoads();
+
+	while (buffer->Ticks() > 1)
+	{
+		std::chrono::steady_clock::time_point rewindStart = std::chrono::steady_clock::now();
+		game.Rewind(1);
+		rewindTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - rewindStart).count());
+	}
+
+	reportStream << std::fixed << std::setprecision(2);
+	reportStream << "recorded: " << ticks << " ticks (" << seconds << " s at " << ticksPerSecond << " Hz), tick time [us]: mean " << tickTime.Mean() / 1000.0 << "\n";
+	reportStream << "encoded [KB]: " << bytes / 1024.0 << " (" << static_cast<double>(bytes) / ticks << " bytes per tick), ring holds " << reservedBytes / 1024.0 << "\n";
+	reportStream << "restore any tick [us]: p50 " << restoreTime.Percentile(50) / 1000.0 << ", p99 " << restoreTime.Percentile(99) / 1000.0 << ", max " << restoreTime.Max() / 1000.0 << "\n";
+	reportStream << "rewind one tick into the game [us]: p50 " << rewindTime.Percentile(50) / 1000.0 << ", p99 " << rewindTime.Percentile(99) / 1000.0 << ", max " << rewindTime.Max() / 1000.0 << ", rooms loaded again " << game.GetLevel()->GetMapLoads() - mapLoads << "\n";
+}
+
+void Simulation::RunTimers(std::ostream& reportStream, const int& tiles, const int& ticks)
+{
+	const int width = 500;
+	reportStream << std::fixed << std::setprecision(2);
+
+	//timed doors and hazards: the same tiles / 100 toggle every 1 to 10 seconds at 30 Hz, the others are scheduled an hour or more ahead
+	for (int timedTiles = tiles / 100; timedTiles <= tiles; timedTiles *= 10)
+	{
+		if (timedTiles == 0)
+		{
+			continue;
+		}
+
+		int height = (timedTiles + width - 1) / width;
+		std::mt19937 generator(1);
+		std::stringstream mapText;
+		mapText << width << " " << height << "\n";
+
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				int period = y * width + x < tiles / 100 ? 30 + static_cast<int>(generator() % 271) : 108000 + static_cast<int>(generator() % 108000);
+				int offset = static_cast<int>(generator() % period);
+
+				if (y * width + x >= timedTiles)
+				{
+					mapText << ".f0/b0 ";
+				}
+				else if (x % 2 == 0)
+				{
+					mapText << "#c/t0," << period << ",32," << offset << "/f7/b0 ";
+				}
+				else
+				{
+					mapText << "^d1/t2," << period << ",46," << offset << "/f1/b0 ";
+				}
+			}
+
+			mapText << "\n";
+		}
+
+		NullScreen screen;
+		Map map(mapText, &screen);
+		long long bytesBefore = screen.BytesWritten();
+		LatencyHistogram tickTime;
+		std::vector<Position> changedPositions;
+		long long toggles = 0;
+
+		for (int i = 0; i < ticks; i++)
+		{
+			changedPositions.clear();
+			std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+			map.AdvanceTimers(changedPositions);
+			tickTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tickStart).count());
+			toggles += changedPositions.size();
+		}
+
+		//what every tick would cost without the wheel: one pass over all timed tiles (rewind still does it once)
+		std::chrono::steady_clock::time_point passStart = std::chrono::steady_clock::now();
+		map.SetTicks(0, changedPositions);
+		double passMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - passStart).count();
+
+		double perTick = ticks > 0 ? 1.0 / ticks : 0.0;
+		reportStream << "timed tiles: " << map.TimedTilesNumber() << ", toggled and drawn per tick " << toggles * perTick << " cells (" << (screen.BytesWritten() - bytesBefore) / (toggles > 0 ? toggles : 1) << " bytes each)\n";
+		reportStream << "  tick [us]: mean " << tickTime.Mean() / 1000.0 << ", p50 " << tickTime.Percentile(50) / 1000.0 << ", p99 " << tickTime.Percentile(99) / 1000.0 << ", max " << tickTime.Max() / 1000.0
+			<< ", per toggle " << (toggles > 0 ? tickTime.Mean() * ticks / toggles : 0.0) << " ns; one pass over all timed tiles " << passMicroseconds << " us\n";
+	}
+}
+
+void Simulation::RunFieldOfView(std::ostream& reportStream, const int& size, const int& radius, const int& ticks)
+{
+	reportStream << std::fixed << std::setprecision(2);
+
+	//dark cave: a quarter of the cells are rock, the eye wanders one cell every other tick and a door in its reach opens or closes every 10 ticks
+	std::mt19937 generator(1);
+	std::stringstream mapText;
+	mapText << size << " " << size << " " << radius << "\n";
+	for (int y = 0; y < size; y++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			mapText << (generator() % 4 == 0 ? "#c/f7/b0 " : ".f0/b0 ");
+		}
+
+		mapText << "\n";
+	}
+
+	NullScreen screen;
+	Map map(mapText, &screen);
+	Position eye = { size / 2, size / 2 };
+	map.SetCollidableAt(eye, false);
+	map.Show();
+
+	const Position steps[4] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+	LatencyHistogram tickTime;
+	long long redrawn = 0;
+	long long visible = 0;
+	long long casts = map.GetView().Casts();
+	long long bytesBefore = screen.BytesWritten();
+
+	for (int i = 0; i < ticks; i++)
+	{
+		if (i % 2 == 0)
+		{
+			Position next = eye + steps[generator() % 4];
+			if (map.InBoundings(next) and !map.CollidingWith(next))
+			{
+				eye = next;
+			}
+		}
+
+		if (i % 10 == 5)
+		{
+			Position door = { eye.x + static_cast<int>(generator() % (2 * radius + 1)) - radius, eye.y + static_cast<int>(generator() % (2 * radius + 1)) - radius };
+			if (map.InBoundings(door) and door != eye)
+			{
+				map.SetCollidableAt(door, !map.CollidingWith(door));
+			}
+		}
+
+		std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+		redrawn += map.UpdateView(eye);
+		tickTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tickStart).count());
+
+		if (i % 100 == 0)
+		{
+			for (int y = eye.y - radius; y <= eye.y + radius; y++)
+			{
+				for (int x = eye.x - radius; x <= eye.x + radius; x++)
+				{
+					visible += map.GetView().Visible({ x, y });
+				}
+			}
+		}
+	}
+
+	//what a tick would cost if the whole room were drawn again instead of the cells that changed
+	std::chrono::steady_clock::time_point showStart = std::chrono::steady_clock::now();
+	map.Show();
+	double showMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - showStart).count();
+
+	casts = map.GetView().Casts() - casts;
+	reportStream << "dark room " << size << "x" << size << ", view radius " << radius << ": " << casts << " casts in " << ticks << " ticks, " << (ticks > 0 ? static_cast<double>(visible) / ((ticks + 99) / 100) : 0.0) << " cells in view\n";
+	reportStream << "  redrawn per cast " << (casts > 0 ? static_cast<double>(redrawn) / casts : 0.0) << " cells (" << (screen.BytesWritten() - bytesBefore) / (ticks > 0 ? ticks : 1) << " bytes per tick)\n";
+	reportStream << "  tick [us]: mean " << tickTime.Mean() / 1000.0 << ", p50 " << tickTime.Percentile(50) / 1000.0 << ", p99 " << tickTime.Percentile(99) / 1000.0 << ", max " << tickTime.Max() / 1000.0
+		<< " (60 Hz frame " << 1000000.0 / 60 << "); drawing the whole room " << showMicroseconds << " us\n";
+}
+
+void Simulation::RunFlowField(std::ostream& reportStream, const int& size, const int& followers, const int& ticks)
+{
+	reportStream << std::fixed << std::setprecision(2);
+
+	//cave as in RunFieldOfView: the player wanders one cell every other tick, now and then diagonally, a door toggles every 100 ticks
+	std::mt19937 generator(1);
+	std::stringstream mapText;
+	mapText << size << " " << size << "\n";
+	for (int y = 0; y < size; y++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			mapText << (generator() % 4 == 0 ? "#c/f7/b0 " : ".f0/b0 ");
+		}
+
+		mapText << "\n";
+	}
+
+	Map map(mapText);
+	Position player = { size / 2, size / 2 };
+	map.SetCollidableAt(player, false);
+
+	std::chrono::steady_clock::time_point searchStart = std::chrono::steady_clock::now();
+	int reachable = map.UpdateFlowField(player);
+	double searchMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - searchStart).count();
+	const FlowField& field = map.GetFlowField();
+
+	std::vector<Position> swarm;
+	while (static_cast<int>(swarm.size()) < followers and reachable > 1)
+	{
+		Position position = { static_cast<int>(generator() % size), static_cast<int>(generator() % size) };
+		if (field.Distance(position) > 0)
+		{
+			swarm.push_back(position);
+		}
+	}
+
+	const Position steps[8] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 } };
+	LatencyHistogram updateTime;
+	LatencyHistogram followTime;
+	LatencyHistogram doorTime;
+	long long written = 0;
+	long long moves = 0;
+	long long rebuilds = field.Rebuilds();
+
+	for (int i = 0; i < ticks; i++)
+	{
+		if (i % 2 == 0)
+		{
+			//nobody slips between two rocks touching at a corner
+			Position next = player + steps[generator() % 8];
+			if (map.InBoundings(next) and !map.CollidingWith(next) and (!map.CollidingWith(Position{ next.x, player.y }) or !map.CollidingWith(Position{ player.x, next.y })))
+			{
+				moves++;
+				player = next;
+			}
+		}
+
+		if (i % 100 == 50)
+		{
+			Position door = { player.x + static_cast<int>(generator() % 21) - 10, player.y + static_cast<int>(generator() % 21) - 10 };
+			if (map.InBoundings(door) and door != player)
+			{
+				std::chrono::steady_clock::time_point doorStart = std::chrono::steady_clock::now();
+				map.SetCollidableAt(door, !map.CollidingWith(door));
+				doorTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - doorStart).count());
+			}
+		}
+
+		std::chrono::steady_clock::time_point updateStart = std::chrono::steady_clock::now();
+		written += map.UpdateFlowField(player);
+		std::chrono::steady_clock::time_point followStart = std::chrono::steady_clock::now();
+		for (Position& follower : swarm)
+		{
+			follower += field.NextStep(follower);
+		}
+
+		std::chrono::steady_clock::time_point tickEnd = std::chrono::steady_clock::now();
+		updateTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(followStart - updateStart).count());
+		followTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(tickEnd - followStart).count());
+	}
+
+	rebuilds = field.Rebuilds() - rebuilds;
+	int caught = static_cast<int>(std::count(swarm.begin(), swarm.end(), player));
+	reportStream << "cave " << size << "x" << size << ": " << reachable << " cells reachable, full search " << searchMicroseconds << " us\n";
+	reportStream << "  player moved " << moves << " times in " << ticks << " ticks, " << rebuilds << " full searches, "
+		<< (moves > 0 ? static_cast<double>(written) / moves : 0.0) << " cells written per move\n";
+	reportStream << "  field update [us]: mean " << updateTime.Mean() / 1000.0 << ", p50 " << updateTime.Percentile(50) / 1000.0 << ", p99 " << updateTime.Percentile(99) / 1000.0 << ", max " << updateTime.Max() / 1000.0
+		<< "; door opened or closed [us]: mean " << doorTime.Mean() / 1000.0 << ", max " << doorTime.Max() / 1000.0 << "\n";
+	reportStream << "  " << swarm.size() << " followers [us]: mean " << followTime.Mean() / 1000.0 << ", p99 " << followTime.Percentile(99) / 1000.0
+		<< " (" << (swarm.empty() ? 0.0 : followTime.Mean() / swarm.size()) << " ns each), " << caught << " on the player's cell at the end\n";
+}
+
+void Simulation::RunEndless(std::ostream& reportStream, const int& chunks, const int& ticks, const double& speedUp)
+{
+	Sound::muted = true;
+	reportStream << std::fixed << std::setprecision(2);
+	const std::string endlessLevel = "levels/endless.level";
+
+	//generation alone: text and parse of chunks on this thread, then on the stream's workers
+	ChunkGenerator generator(1, 60, 15);
+	std::chrono::steady_clock::time_point textStart = std::chrono::steady_clock::now();
+	size_t bytes = 0;
+	for (int i = 0; i < chunks; i++)
+	{
+		std::istringstream mapStream(generator.Generate(i));
+		bytes += mapStream.str().size();
+		Map map(mapStream);
+	}
+
+	double oneThreadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - textStart).count();
+	reportStream << "chunks " << generator.GetWidth() << "x" << generator.GetHeight() << ": " << chunks / oneThreadSeconds << " chunks/s on one thread ("
+		<< oneThreadSeconds * 1000000.0 / chunks << " us each, " << bytes / chunks << " bytes of .map text)\n";
+
+	for (int threads = 1; threads <= 4; threads *= 2)
+	{
+		std::chrono::steady_clock::time_point streamStart = std::chrono::steady_clock::now();
+		ChunkStream stream(1, 60, 15, chunks - 1, threads);
+		while (stream.Generated() < chunks)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - streamStart).count();
+		reportStream << "  " << threads << " worker(s): " << chunks / seconds << " chunks/s\n";
+	}
+
+	//a runner holding right and jump, rooms entered one after another while the workers keep ahead
+	//ticks are paced at speedUp times 30 Hz, the game thread sleeps between them like the real loop (0 - no pacing)
+	std::chrono::nanoseconds tickInterval(speedUp > 0.0 ? static_cast<long long>(1000000000 / 30 / speedUp) : 0);
+	ManualInput* input = new ManualInput();
+	input->SetKeys((1 << static_cast<int>(KEY::RIGHT)) | (1 << static_cast<int>(KEY::UP)));
+	Game game({ endlessLevel }, new NullScreen(), input, &_mapLibrary);
+	game.StartLevel(0);
+
+	LatencyHistogram tickTime;
+	LatencyHistogram switchTime; //ticks that entered a room
+	long long requests = 0;
+	long long stalls = 0;
+	double marginSum = 0.0;
+	int minMargin = -1;
+	int rooms = 0;
+	int restarts = 0;
+
+	//every restart makes a new level with its own stream
+	std::function<void()> addStream = [&]()
+	{
+		ChunkStream* stream = game.GetLevel()->GetChunkStream();
+		requests += stream->Requests();
+		stalls += stream->Stalls();
+		marginSum += stream->MeanMargin() * stream->Requests();
+		if (stream->MinMargin() != -1)
+		{
+			minMargin = minMargin == -1 ? stream->MinMargin() : std::min(minMargin, stream->MinMargin());
+		}
+	};
+
+	std::chrono::steady_clock::time_point scheduled = std::chrono::steady_clock::now();
+	for (int i = 0; i < ticks; i++)
+	{
+		scheduled += tickInterval;
+		std::this_thread::sleep_until(scheduled);
+
+		int room = game.GetLevel()->GetMapIndex();
+		std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+		game.Tick();
+		long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tickStart).count();
+		tickTime.Add(nanoseconds);
+
+		if (game.GetLevel()->GetMapIndex() != room)
+		{
+			switchTime.Add(nanoseconds);
+			rooms++;
+		}
+
+		if (game.GetLevel()->Ended())
+		{
+			addStream();
+			game.RestartLevel();
+			restarts++;
+		}
+	}
+
+	addStream();
+	reportStream << "runner at " << (speedUp > 0.0 ? 30.0 * speedUp : 0.0) << " Hz: " << rooms << " rooms entered in " << ticks << " ticks (" << restarts << " restarts), " << stalls << " of " << requests << " rooms waited for their chunk\n";
+	reportStream << "  margin: " << (requests > 0 ? marginSum / requests : 0.0) << " chunks ready ahead on average, at least " << minMargin << "\n";
+	reportStream << "  tick [us]: mean " << tickTime.Mean() / 1000.0 << ", p99 " << tickTime.Percentile(99) / 1000.0 << "; entering a room: mean " << switchTime.Mean() / 1000.0 << ", max " << switchTime.Max() / 1000.0 << "\n";
+}
+
+void Simulation::RunBroadcast(std::ostream& reportStream, const int& viewers, const int& ticks)
+{
+	Sound::muted = true;
+	const std::chrono::nanoseconds tickInterval(1000000000 / 30);
+	int stalled = viewers / 20;
+
+	BroadcastServer server(0, 16 * 1024);
+	LocalViewers localViewers(server.Port(), viewers, stalled);
+
+	//all viewers are connected (and waiting for their keyframe) before the game starts
+	while (server.Viewers() < viewers)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	{
+		Game game(_levels, new ThreadedScreen(new NullScreen(), &server), new RandomInput(1), &_mapLibrary);
+		game.StartLevel(0);
+		std::chrono::steady_clock::time_point scheduled = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < ticks; i++)
+		{
+			std::this_thread::sleep_until(scheduled);
+			game.Tick();
+			if (game.GetLevel()->Ended())
+			{
+				game.RestartLevel();
+			}
+
+			scheduled += tickInterval;
+		}
+	} //the game's screen presents its last frame here
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(200)); //viewers read what is still on its way
+	localViewers.Stop();
+
+	server.Report(reportStream);
+	reportStream << "local viewers: " << viewers << " (" << stalled << " never read), " << localViewers.Closed() << " closed by the server, "
+		<< localViewers.Received() / 1024.0 << " KB received, per reading viewer " << localViewers.MinReceived() / 1024.0 << " - " << localViewers.MaxReceived() / 1024.0 << " KB\n";
+}
+
+void Simulation::RunRenderJitter(std::ostream& reportStream, const int& ticks, const double& nanosecondsPerByte)
+{
+	Sound::muted = true;
+	const std::chrono::nanoseconds tickInterval(1000000000 / 30);
+
+	reportStream << std::fixed << std::setprecision(2);
+
+	for (int run = 0; run < 4; run++)
+	{
+		bool slowTerminal = run % 2 == 1;
+		bool renderThread = run >= 2;
+
+		Screen* screen = new SlowScreen(new NullScreen(), slowTerminal ? nanosecondsPerByte : 0.0);
+		if (renderThread)
+		{
+			screen = new ThreadedScreen(screen);
+		}
+
+		//same input in every run, ticks scheduled at 30 per second like the game loop
+		Game game(_levels, screen, new RandomInput(1), &_mapLibrary);
+		game.StartLevel(0);
+
+		LatencyHistogram tickTime;
+		LatencyHistogram lateness; //how long after its scheduled time a tick started
+		std::chrono::steady_clock::time_point scheduled = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < ticks; i++)
+		{
+			std::this_thread::sleep_until(scheduled);
+			std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+			lateness.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(tickStart - scheduled).count());
+
+			game.Tick();
+			if (game.GetLevel()->Ended())
+			{
+				game.RestartLevel();
+			}
+
+			tickTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tickStart).count());
+			scheduled += tickInterval;
+			if (scheduled < std::chrono::steady_clock::now())
+			{
+				scheduled = std::chrono::steady_clock::now(); //a late tick does not make the next ones rush
+			}
+		}
+
+		reportStream << (renderThread ? "render thread" : "game thread  ") << (slowTerminal ? ", slow terminal: " : ", fast terminal: ");
+		reportStream << "tick [us] p50 " << tickTime.Percentile(50) / 1000.0 << ", p99 " << tickTime.Percentile(99) / 1000.0 << ", max " << tickTime.Max() / 1000.0;
+		reportStream << " - start lateness [us] p99 " << lateness.Percentile(99) / 1000.0 << ", max " << lateness.Max() / 1000.0 << "\n";
+	}
+}
+
+void Simulation::RunIdleMenu(std::ostream& reportStream, const int& seconds)
+{
+	Sound::muted = true;
+	reportStream << std::fixed << std::setprecision(2);
+
+	//the start screen of a headless game with nobody at the keys
+	ManualInput* input = new ManualInput();
+	Game game(_levels, new NullScreen(), input, &_mapLibrary);
+	std::thread menu([&game]() { game.Start(); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(200)); //drawn and waiting
+
+	double cpuBefore = CpuSeconds();
+	std::chrono::steady_clock::time_point idleStart = std::chrono::steady_clock::now();
+	std::this_thread::sleep_for(std::chrono::seconds(seconds));
+	double cpuSeconds = CpuSeconds() - cpuBefore;
+	double idleSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - idleStart).count();
+
+	//up wraps around to Exit, then enter, every key released before the next one
+	const int keys[4] = { 1 << static_cast<int>(KEY::UP), 0, 1 << static_cast<int>(KEY::ENTER), 0 };
+	for (const int& key : keys)
+	{
+		input->SetKeys(key);
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	}
+
+	menu.join();
+
+	reportStream << "start screen idle for " << idleSeconds << " s: " << cpuSeconds * 1000.0 << " ms of CPU time, "
+		<< cpuSeconds * 60000.0 / idleSeconds << " ms per idle minute (" << 100.0 * cpuSeconds / idleSeconds << "% of a core)\n";
+}
+
+void Simulation::RunInputLatency(std::ostream& reportStream, const int& presses)
+{
+	Sound::muted = true;
+	reportStream << std::fixed << std::setprecision(2);
+#ifdef NDEBUG
+	reportStream << "release build, " << presses << " presses per run\n";
+#else
+	reportStream << "debug build, " << presses << " presses per run\n";
+#endif
+
+	std::mt19937 generator(1);
+
+	for (int run = 0; run < 2; run++)
+	{
+		bool renderThread = run == 1;
+
+		//the real game loop, its keys injected and its output read back as a terminal would show it
+		ProbeInput* input = new ProbeInput();
+		ProbeScreen* probe = new ProbeScreen();
+		Game game(_levels, renderThread ? static_cast<Screen*>(new ThreadedScreen(probe)) : probe, input, &_mapLibrary);
+		game.StartLevel(0);
+
+		std::vector<std::pair<Position, char>> pattern;
+		for (const EntityTile& tile : game.GetLevel()->GetPlayer()->GetBody())
+		{
+			pattern.push_back({ tile.GetPosition(), tile.GetCharacter() });
+		}
+
+		probe->Watch(pattern);
+		std::thread loop([&game]() { game.GameLoop(); });
+
+		LatencyHistogram latency; //key injected to the player moved on the terminal
+		LatencyHistogram pollWait; //key injected to the first Poll after it
+		LatencyHistogram output; //that Poll to the player moved on the terminal
+		int missed = 0;
+
+		for (int i = 0; i < presses; i++)
+		{
+			//the player stands still (landed, nothing pressed), the press comes at a random point of the frame
+			long long moves;
+			do
+			{
+				moves = probe->Moves();
+				std::this_thread::sleep_for(std::chrono::milliseconds(200));
+			} while (probe->Moves() != moves);
+			std::this_thread::sleep_for(std::chrono::microseconds(generator() % 50000));
+
+			//left and right in turns, so the player walks back and forth around the start
+			moves = probe->Moves();
+			long long injectedAt = input->Inject(1 << static_cast<int>(i % 2 == 0 ? KEY::RIGHT : KEY::LEFT));
+			std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+			while (probe->Moves() == moves and std::chrono::steady_clock::now() < deadline)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			if (probe->Moves() != moves)
+			{
+				long long movedAt = probe->MovedAt();
+				latency.Add(movedAt - injectedAt);
+				pollWait.Add(input->SeenAt() - injectedAt);
+				output.Add(movedAt - input->SeenAt());
+			}
+			else
+			{
+				missed++; //blocked, or the level ended
+			}
+
+			input->Inject(0);
+		}
+
+		game.Stop();
+		loop.join();
+
+		reportStream << (renderThread ? "render thread" : "game thread  ") << ": key to terminal [ms] p50 " << latency.Percentile(50) / 1000000.0
+			<< ", p99 " << latency.Percentile(99) / 1000000.0 << ", max " << latency.Max() / 1000000.0
+			<< " - waiting for the poll p50 " << pollWait.Percentile(50) / 1000000.0 << ", p99 " << pollWait.Percentile(99) / 1000000.0
+			<< "; poll to terminal p50 " << output.Percentile(50) / 1000000.0 << ", p99 " << output.Percentile(99) / 1000000.0
+			<< "; no move within 1 s " << missed << "\n";
+	}
+}
+
+void Simulation::RunLiveRooms(std::ostream& reportStream, const int& rooms, const int& ticks, const int& interval)
+{
+	const int width = 50;
+	const int height = 15;
+	const int timedTiles = 50; //per room with timed tiles
+	reportStream << std::fixed << std::setprecision(2);
+
+	//two rooms, a level lists them as many times as it needs, every entry is a room of its own
+	MapLibrary library;
+	std::mt19937 generator(1);
+	for (int timed = 0; timed < 2; timed++)
+	{
+		std::stringstream mapText;
+		mapText << width << " " << height << "\n";
+
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				int period = 30 + static_cast<int>(generator() % 271);
+				if (y == height - 1)
+				{
+					mapText << "#c/f7/b7 ";
+				}
+				else if (timed == 1 and y == height - 2 and x < timedTiles)
+				{
+					mapText << "^d1/t2," << period << ",46," << generator() % period << "/f1/b0 ";
+				}
+				else
+				{
+					mapText << ".f0/b0 ";
+				}
+			}
+
+			mapText << "\n";
+		}
+
+		library.Add(timed == 1 ? "rooms/timed.map" : "rooms/static.map", mapText);
+	}
+
+	//rooms, rooms with timed tiles, ticks between batches
+	std::vector<std::vector<int>> runs;
+	for (int roomsNumber = std::max(rooms / 100, 1); roomsNumber <= rooms; roomsNumber *= 10)
+	{
+		runs.push_back({ roomsNumber, std::min(roomsNumber, 10), interval });
+	}
+
+	if (rooms / 10 > 10)
+	{
+		runs.push_back({ rooms, rooms / 10, interval });
+	}
+
+	runs.push_back({ rooms, rooms, interval });
+	runs.push_back({ rooms, rooms, 1 });
+
+	for (const std::vector<int>& run : runs)
+	{
+		std::stringstream levelText;
+		levelText << run[0] << "\n";
+		for (int i = 0; i < run[0]; i++)
+		{
+			levelText << (i < run[1] ? "rooms/timed.map" : "rooms/static.map") << "\n";
+		}
+
+		levelText << "1 [@1,1] 10 4\n0\n";
+
+		NullScreen screen;
+		Level level(levelText, &screen, &library);
+		std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+		level.KeepRoomsLive(run[2]);
+		double loadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+		LatencyHistogram tickTime; //on the game thread: the current room and handing out batches
+		LatencyHistogram enterTime;
+		std::vector<Position> changedPositions;
+		double cpuBefore = CpuSeconds();
+
+		for (int i = 1; i <= ticks; i++)
+		{
+			std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+			level.GetMap()->AdvanceTimers(changedPositions);
+			changedPositions.clear();
+			level.AdvanceRooms();
+			tickTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tickStart).count());
+
+			//the player goes through the rooms with timed tiles, ten seconds in each
+			if (i % 300 == 0)
+			{
+				std::chrono::steady_clock::time_point enterStart = std::chrono::steady_clock::now();
+				level.EnterMap((level.GetMapIndex() + 1) % std::max(run[1], 1));
+				enterTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - enterStart).count());
+			}
+		}
+
+		double cpuSeconds = CpuSeconds() - cpuBefore;
+		double perTick = ticks > 0 ? 1.0 / ticks : 0.0;
+
+		reportStream << "rooms " << level.LiveRooms() << " (" << level.DynamicRooms() << " with timed tiles), others every " << run[2] << " ticks, kept live in " << loadMilliseconds << " ms\n";
+		reportStream << "  game thread tick [us]: p50 " << tickTime.Percentile(50) / 1000.0 << ", p99 " << tickTime.Percentile(99) / 1000.0 << ", max " << tickTime.Max() / 1000.0
+			<< "; worker per tick " << level.RoomMicroseconds() * perTick << " us (" << level.RoomSteps() / std::max(level.RoomBatches(), 1LL) << " rooms a batch)"
+			<< "; entering a room [us] p50 " << enterTime.Percentile(50) / 1000.0 << ", max " << enterTime.Max() / 1000.0
+			<< "; process CPU per tick " << cpuSeconds * 1000000.0 * perTick << " us\n";
+	}
+
+	//the player walks back and forth between two rooms, every frame has to be the same as with rooms loaded fresh on entering
+	std::vector<unsigned long long> frames[2];
+	int entered = 0;
+	for (int live = 0; live < 2; live++)
+	{
+		std::istringstream script("R\n");
+		HashScreen* screen = new HashScreen();
+		Game game({ "benchmarks/rooms.level" }, screen, new ScriptedInput(script), &_mapLibrary);
+		game.SetLiveRooms(live == 1 ? interval : 0);
+		game.StartLevel(0);
+
+		for (int i = 0; i < ticks and !game.GetLevel()->Ended(); i++)
+		{
+			game.Tick();
+		}
+
+		frames[live] = screen->FrameHashes();
+		entered = game.GetLevel()->GetMapLoads() - 1;
+	}
+
+	size_t frame = 0;
+	while (frame < frames[0].size() and frame < frames[1].size() and frames[0][frame] == frames[1][frame])
+	{
+		frame++;
+	}
+
+	reportStream << "leaving rooms and coming back, " << entered << " rooms entered: ";
+	if (frame < frames[0].size() or frame < frames[1].size())
+	{
+		reportStream << "FAILED - frame " << frame << " differs from the one with rooms loaded fresh\n";
+	}
+	else
+	{
+		reportStream << frames[1].size() << " frames the same as with rooms loaded fresh\n";
+	}
+}
+
+void Simulation::RunTriggerEffects(std::ostream& reportStream, const int& ticks)
+{
+	Sound::muted = true;
+	reportStream << std::fixed << std::setprecision(2);
+
+	//pickups on hazards that take no hp: every cell the player touches runs triggers every tick, restarts bring the pickups back
+	NullScreen* screen = new NullScreen();
+	Game game({ "benchmarks/triggers.level" }, screen, new RandomInput(1), &_mapLibrary);
+	game.StartLevel(0);
+
+	LatencyHistogram tickTime;
+	long long bytes = 0;
+
+	for (int i = 0; i < ticks; i++)
+	{
+		long long bytesBefore = screen->BytesWritten();
+		std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+		game.Tick();
+		tickTime.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tickStart).count());
+		bytes += screen->BytesWritten() - bytesBefore;
+
+		if (i % 300 == 299 or game.GetLevel()->Ended())
+		{
+			game.RestartLevel();
+		}
+	}
+
+	double perTick = ticks > 0 ? 1.0 / ticks : 0.0;
+	reportStream << "trigger-heavy room, " << ticks << " ticks: effects asked for per tick " << game.GetEffects().Recorded() * perTick << ", done " << game.GetEffects().Run() * perTick
+		<< "; tick [us] p50 " << tickTime.Percentile(50) / 1000.0 << ", p99 " << tickTime.Percentile(99) / 1000.0 << ", max " << tickTime.Max() / 1000.0
+		<< "; bytes per tick " << bytes * perTick << "\n";
+}
+
+void Simulation::RunTileArchetypes(std::ostream& reportStream, const int& width, const int& height)
+{
+	reportStream << std::fixed << std::setprecision(2);
+
+	for (const std::string& levelFilename : _levels)
+	{
+		std::ifstream levelStream(levelFilename);
+		if (!levelStream.good())
+		{
+			throw new Exception(1, "[SIMULATION] level file open error.");
+		}
+
+		Level level(levelStream, nullptr, &_mapLibrary);
+		levelStream.close();
+
+		for (const std::string& mapFilename : level.GetMapFilenames())
+		{
+			std::ifstream mapStream(mapFilename);
+			std::stringstream mapText;
+			mapText << mapStream.rdbuf();
+			ReportTiles(reportStream, mapFilename, mapText.str());
+		}
+	}
+
+	ChunkGenerator generator(1, width, height);
+	ReportTiles(reportStream, "generated room", generator.Generate(0));
+}
+
+void Simulation::ReportTiles(std::ostream& reportStream, const std::string& name, const std::string& mapText)
+{
+	ArenaScope scope(nullptr); //tagged blocks from the heap, so every one is counted as it is freed
+
+	long long bytesBefore = TileBytes();
+	std::chrono::steady_clock::time_point parseStart = std::chrono::steady_clock::now();
+	std::istringstream mapStream(mapText);
+	Map map(mapStream);
+	double parseMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - parseStart).count();
+	long long bytes = TileBytes() - bytesBefore;
+
+	//entering a room copies its parsed map
+	std::chrono::steady_clock::time_point copyStart = std::chrono::steady_clock::now();
+	Map copy(map);
+	double copyMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - copyStart).count();
+
+	//what the cells took as one EntityTile each in both layers, without block headers
+	long long flatBytes = 0;
+	for (int x = 0; x < map.GetWidth(); x++)
+	{
+		for (int y = 0; y < map.GetHeight(); y++)
+		{
+			long long tileBytes = sizeof(EntityTile);
+			for (const Option& option : map.AtOriginal({ x, y }).GetOptions())
+			{
+				tileBytes += sizeof(Option) + option.arguments.size() * sizeof(int);
+			}
+
+			flatBytes += 2 * tileBytes;
+		}
+	}
+
+	reportStream << name << " " << map.GetWidth() << "x" << map.GetHeight() << ": " << map.ArchetypesNumber() << " archetypes, " << bytes / 1024.0 << " KB of tiles, one tile per cell "
+		<< flatBytes / 1024.0 << " KB (" << (bytes > 0 ? static_cast<double>(flatBytes) / bytes : 0.0) << "x); parse " << parseMicroseconds << " us, copy " << copyMicroseconds << " us\n";
+}
+
+bool Simulation::RunBenchmark(std::ostream& reportStream, const int& runs, const bool& record)
+{
+	Sound::muted = true;
+	reportStream << std::fixed << std::setprecision(2);
+
+	bool passed = true;
+	LatencyHistogram allTicks;
+
+	for (const std::string& levelFilename : _levels)
+	{
+		//levels/level1.level plays benchmarks/level1.script
+		std::string name = levelFilename.substr(levelFilename.find_last_of("/\\") + 1);
+		name = "benchmarks/" + name.substr(0, name.find_last_of('.'));
+
+		std::ifstream scriptStream(name + ".script");
+		if (!scriptStream.good())
+		{
+			throw new Exception(1, "[SIMULATION] benchmark script open error.");
+		}
+
+		std::stringstream script;
+		script << scriptStream.rdbuf();
+		scriptStream.close();
+
+		std::vector<unsigned long long> golden;
+		if (!record)
+		{
+			std::ifstream goldenStream(name + ".golden");
+			if (!goldenStream.good())
+			{
+				throw new Exception(1, "[SIMULATION] golden checksums open error, record them with --benchmark-record.");
+			}
+
+			std::string hashLine;
+			while (std::getline(goldenStream, hashLine))
+			{
+				golden.push_back(std::stoull(hashLine, nullptr, 16));
+			}
+
+			goldenStream.close();
+		}
+
+		LatencyHistogram tickLatency;
+		std::vector<long long> frameBytes;
+		std::string outcome;
+		int rooms = 0;
+		int score = 0;
+		int hp = 0;
+		int maxHp = 0;
+
+		for (int run = 0; run < runs and outcome.empty(); run++)
+		{
+			std::istringstream runScript(script.str());
+			ScriptedInput* input = new ScriptedInput(runScript);
+			HashScreen* screen = new HashScreen();
+			Game game({ levelFilename }, screen, input, &_mapLibrary);
+			game.StartLevel(0); //drawn into the first frame
+
+			//one pass of the script, it has to reach the exit
+			for (int tick = 0; tick < input->Length() and !game.GetLevel()->Ended(); tick++)
+			{
+				std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+				game.Tick();
+				tickLatency.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tickStart).count());
+			}
+
+			Level* level = game.GetLevel();
+			if (!level->Ended())
+			{
+				outcome = "the script ended before the level";
+				break;
+			}
+
+			if (level->GetPlayer()->Dead())
+			{
+				outcome = "the player died";
+				break;
+			}
+
+			const std::vector<unsigned long long>& hashes = screen->FrameHashes();
+			if (record and golden.empty())
+			{
+				golden = hashes;
+				std::ofstream goldenStream(name + ".golden");
+				for (const unsigned long long& hash : hashes)
+				{
+					goldenStream << std::hex << std::setw(16) << std::setfill('0') << hash << "\n";
+				}
+
+				if (!goldenStream.good())
+				{
+					throw new Exception(1, "[SIMULATION] golden checksums write error.");
+				}
+
+				goldenStream.close();
+			}
+
+			//the first frame that differs, a run that is shorter or longer differs where one of them ends
+			size_t frame = 0;
+			while (frame < hashes.size() and frame < golden.size() and hashes[frame] == golden[frame])
+			{
+				frame++;
+			}
+
+			if (frame < hashes.size() or frame < golden.size())
+			{
+				outcome = "frame " + std::to_string(frame) + " of run " + std::to_string(run + 1) + " differs from the golden checksums";
+				break;
+			}
+
+			frameBytes = screen->FrameBytes();
+			rooms = level->GetMapLoads();
+			score = level->GetScore();
+			hp = level->GetPlayer()->Hp();
+			maxHp = level->GetPlayer()->MaxHp();
+		}
+
+		allTicks.Merge(tickLatency);
+		reportStream << levelFilename << ": ";
+
+		if (!outcome.empty())
+		{
+			passed = false;
+			reportStream << "FAILED - " << outcome << "\n";
+			continue;
+		}
+
+		long long bytes = 0;
+		long long maxBytes = 0;
+		for (const long long& frameSize : frameBytes)
+		{
+			bytes += frameSize;
+			maxBytes = std::max(maxBytes, frameSize);
+		}
+
+		reportStream << golden.size() << " frames " << (record ? "recorded" : "match") << " in " << runs << " run(s), " << rooms << " room(s) entered, score " << score << ", hp " << hp << " of " << maxHp << "\n";
+		reportStream << "  " << (tickLatency.Count() > 0 ? 1e9 / tickLatency.Mean() : 0.0) << " ticks/s, tick [us]: mean " << tickLatency.Mean() / 1000.0 << ", p99 " << tickLatency.Percentile(99) / 1000.0 << ", max " << tickLatency.Max() / 1000.0 << "\n";
+		reportStream << "  render bytes per frame: mean " << (frameBytes.empty() ? 0.0 : static_cast<double>(bytes) / frameBytes.size()) << ", max " << maxBytes << " (first frame draws the level)\n";
+	}
+
+	MemoryStats::FlushThread();
+	long long taggedPeak = 0;
+	for (int i = 0; i < static_cast<int>(MEMORY_TAG::COUNT); i++)
+	{
+		taggedPeak += MemoryStats::PeakBytes(static_cast<MEMORY_TAG>(i));
+	}
+
+	reportStream << "all levels: " << allTicks.Count() << " ticks, " << (allTicks.Count() > 0 ? 1e9 / allTicks.Mean() : 0.0) << " ticks/s\n";
+	reportStream << "peak memory [KB]: working set " << PeakWorkingSet() / 1024 << ", tagged " << taggedPeak / 1024 << "\n";
+	reportStream << (passed ? "PASSED" : "FAILED") << "\n";
+	return passed;
+}
+
+void Simulation::RunFrameEncoder(std::ostream& reportStream, const int& width, const int& height, const int& frames)
+{
+	reportStream << std::fixed << std::setprecision(2);
+
+	//a map-like frame: runs of 1 to 12 cells in one of 8 colors, no cell blank, so against a blank screen every cell is drawn
+	std::mt19937 generator(1);
+	std::vector<std::string> styleTexts = { "" };
+	for (int i = 0; i < 7; i++)
+	{
+		styleTexts.push_back("\u001b[" + std::to_string(40 + i) + "m\u001b[" + std::to_string(91 + i % 7) + "m");
+	}
+
+	int cells = width * height;
+	std::vector<char> glyphs(cells);
+	std::vector<unsigned short> styles(cells);
+	for (int i = 0; i < cells;)
+	{
+		int run = 1 + static_cast<int>(generator() % 12);
+		unsigned short style = static_cast<unsigned short>(generator() % styleTexts.size());
+		for (int end = std::min(cells, i + run); i < end; i++)
+		{
+			glyphs[i] = static_cast<char>('!' + generator() % 94);
+			styles[i] = style;
+		}
+	}
+
+	std::vector<char> blankGlyphs(cells, ' ');
+	std::vector<unsigned short> blankStyles(cells, 0);
+
+	//the next frame: 2% of the cells changed, as when a few entities move
+	std::vector<char> nextGlyphs = glyphs;
+	for (int i = 0; i < cells / 50; i++)
+	{
+		int cell = static_cast<int>(generator() % cells);
+		nextGlyphs[cell] = nextGlyphs[cell] == '@' ? '#' : '@';
+	}
+
+	//the way frames were drawn before: a string per run of changed cells, a cursor move and the run streamed out
+	std::ostringstream stream;
+	std::chrono::steady_clock::time_point streamStart = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		stream.str("");
+		for (int y = 0; y < height; y++)
+		{
+			int x = 0;
+			while (x < width)
+			{
+				int i = y * width + x;
+				if (glyphs[i] == blankGlyphs[i] and styles[i] == blankStyles[i])
+				{
+					x++;
+					continue;
+				}
+
+				std::string run;
+				int runStart = x;
+				int style = -1;
+				while (x < width and (glyphs[y * width + x] != blankGlyphs[y * width + x] or styles[y * width + x] != blankStyles[y * width + x]))
+				{
+					if (styles[y * width + x] != style)
+					{
+						run += "\u001b[0m" + styleTexts[styles[y * width + x]];
+						style = styles[y * width + x];
+					}
+
+					run += glyphs[y * width + x];
+					x++;
+				}
+
+				stream << "\u001b[" << y + 1 << ";" << runStart + 1 << "H" << run + "\u001b[0m";
+			}
+		}
+	}
+
+	double streamMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - streamStart).count() / frames;
+	std::string streamed = stream.str();
+
+	FrameEncoder encoder;
+	const char* shownGlyphs[3] = { blankGlyphs.data(), glyphs.data(), glyphs.data() };
+	const char* frameGlyphs[3] = { glyphs.data(), nextGlyphs.data(), glyphs.data() };
+	const unsigned short* shownStyles[3] = { blankStyles.data(), styles.data(), styles.data() };
+	const char* names[3] = { "full redraw", "2% changed ", "unchanged  " };
+	double encoderMicroseconds[3];
+	size_t encodedBytes[3];
+
+	for (int kind = 0; kind < 3; kind++)
+	{
+		std::chrono::steady_clock::time_point encodeStart = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			encoder.Clear();
+			encoder.Encode(frameGlyphs[kind], styles.data(), shownGlyphs[kind], shownStyles[kind], width, height, styleTexts);
+		}
+
+		encoderMicroseconds[kind] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - encodeStart).count() / frames;
+		encodedBytes[kind] = encoder.Size();
+	}
+
+	encoder.Clear();
+	encoder.Encode(glyphs.data(), styles.data(), blankGlyphs.data(), blankStyles.data(), width, height, styleTexts);
+	bool same = streamed == std::string(encoder.Data(), encoder.Size());
+
+	reportStream << "frame " << width << "x" << height << ", " << styleTexts.size() << " styles, " << frames << " frames\n";
+	reportStream << "  strings and stream, full redraw: " << streamMicroseconds << " us/frame, " << streamed.size() << " bytes, "
+		<< streamed.size() / streamMicroseconds << " MB/s\n";
+	for (int kind = 0; kind < 3; kind++)
+	{
+		reportStream << "  encoder, " << names[kind] << ":       " << encoderMicroseconds[kind] << " us/frame, " << encodedBytes[kind] << " bytes";
+		if (encodedBytes[kind] > 0)
+		{
+			reportStream << ", " << encodedBytes[kind] / encoderMicroseconds[kind] << " MB/s";
+		}
+
+		reportStream << "\n";
+	}
+
+	reportStream << "  full redraw " << streamMicroseconds / encoderMicroseconds[0] << "x faster, same bytes: " << (same ? "yes" : "no") << "\n";
+}
+
+size_t Simulation::WorkingSet()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	counters.cb = sizeof(counters);
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+
+	return counters.WorkingSetSize;
+}
+
+size_t Simulation::PeakWorkingSet()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	counters.cb = sizeof(counters);
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+
+	return counters.PeakWorkingSetSize;
+}
+
+long long Simulation::TileBytes()
+{
+	MemoryStats::FlushThread();
+	return MemoryStats::LiveBytes(MEMORY_TAG::TILES) + MemoryStats::LiveBytes(MEMORY_TAG::ORIGINAL_TILES) + MemoryStats::LiveBytes(MEMORY_TAG::OPTIONS);
+}
+
+double Simulation::CpuSeconds()
+{
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+	{
+		return 0.0;
+	}
+
+	//100 ns units
+	unsigned long long kernelTime = static_cast<unsigned long long>(kernel.dwHighDateTime) << 32 | kernel.dwLowDateTime;
+	unsigned long long userTime = static_cast<unsigned long long>(user.dwHighDateTime) << 32 | user.dwLowDateTime;
+	return (kernelTime + userTime) / 10000000.0;
+}
+
+void Simulation::RunSlice(WorkStealingPool& pool, const std::shared_ptr<Session>& session, const int& sliceTicks)
+{
+	try
+	{
+		if (session->game == nullptr)
+		{
+			Input* input = nullptr;
+			if (_script.empty())
+			{
+				input = new RandomInput(static_cast<unsigned int>(session->index + 1));
+			}
+			else
+			{
+				std::istringstream scriptStream(_script);
+				input = new ScriptedInput(scriptStream);
+			}
+
+			session->game.reset(new Game(_levels, new NullScreen(), input, &_mapLibrary));
+			session->game->StartLevel(session->index % static_cast<int>(_levels.size()));
+		}
+
+		for (int i = 0; i < sliceTicks and session->ticksLeft > 0; i++)
+		{
+			std::chrono::steady_clock::time_point tickStart = std::chrono::steady_clock::now();
+			session->game->Tick();
+			session->tickLatency.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tickStart).count());
+			session->ticksLeft--;
+
+			if (session->game->GetLevel()->Ended())
+			{
+				session->game->RestartLevel();
+				session->restarts++;
+			}
+		}
+	}
+	catch (Exception* exception)
+	{
+		delete exception;
+		session->game.reset();
+
+		std::lock_guard<std::mutex> lock(_resultsMutex);
+		_failedSessions++;
+		return;
+	}
+
+	if (session->ticksLeft > 0)
+	{
+		//goes to this worker's deque - it continues here unless another worker steals it
+		pool.Submit([this, &pool, session, sliceTicks]() { RunSlice(pool, session, sliceTicks); });
+	}
+	else
+	{
+		Finish(*session);
+	}
+}
+
+void Simulation::Finish(Session& session)
+{
+	session.game.reset();
+
+	std::lock_guard<std::mutex> lock(_resultsMutex);
+	_ticks += session.tickLatency.Count();
+	_restarts += session.restarts;
+	_tickLatency.Merge(session.tickLatency);
+	_sessionP99.Add(session.tickLatency.Percentile(99));
+}
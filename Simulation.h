@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <Psapi.h>
+#include "Game.h"
+#include "MapLibrary.h"
+#include "WorkStealingPool.h"
+#include "LatencyHistogram.h"
+#include "ThreadedScreen.h"
+#include "FrameEncoder.h"
+#include "BroadcastServer.h"
+
+// load test: many independent headless games (own Level, Map and Player) played on a work-stealing pool
+// sessions run in slices, so idle workers can steal whole sessions from busy ones
+
+class Simulation
+{
+private:
+	struct Session
+	{
+		int index;
+		std::unique_ptr<Game> game;
+		int ticksLeft;
+		int restarts;
+		LatencyHistogram tickLatency;
+	};
+
+	std::vector<std::string> _levels;
+	int _sessionsNumber;
+	int _ticksPerSession;
+	int _threads;
+	std::string _script; //empty - random input
+	MapLibrary _mapLibrary; //every .map file parsed once for all sessions
+	std::mutex _resultsMutex;
+	LatencyHistogram _tickLatency; //all ticks of all sessions
+	LatencyHistogram _sessionP99; //p99 tick latency of every session
+	long long _ticks;
+	long long _restarts;
+	int _failedSessions;
+
+	void RunSlice(WorkStealingPool& pool, const std::shared_ptr<Session>& session, const int& sliceTicks);
+	void Finish(Session& session); //frees the game and adds the session's results
+	static size_t WorkingSet(); //resident memory of the process in bytes
+	static size_t PeakWorkingSet(); //the most resident memory the process had so far
+	static long long TileBytes(); //live tagged bytes of map cells, archetypes and their options
+	static void ReportTiles(std::ostream& reportStream, const std::string& name, const std::string& mapText); //one map's cells as archetypes against one tile per cell
+	static double CpuSeconds(); //user and kernel time of the process
+
+public:
+	Simulation(const std::vector<std::string>& levels, const int& sessions, const int& ticksPerSession, const int& threads = 0, const std::string& scriptFilename = "");
+	void Run(std::ostream& reportStream);
+	void RunRestarts(std::ostream& reportStream, const int& restarts); //load time, arena allocations and memory over many level restarts of one game
+	void RunRewind(std::ostream& reportStream, const int& seconds, const int& ticksPerSecond); //rewind buffer size for seconds of play and the time to restore ticks from it
+	void RunTimers(std::ostream& reportStream, const int& tiles, const int& ticks); //cost of a tick of maps with tiles / 100, tiles / 10 and tiles timed tiles, the same ones toggling in all
+	void RunFieldOfView(std::ostream& reportStream, const int& size, const int& radius, const int& ticks); //cost of keeping the view of a wandering player in a dark size x size cave with doors opening and closing
+	void RunFlowField(std::ostream& reportStream, const int& size, const int& followers, const int& ticks); //cost of one shared distance field for followers of a wandering player in a size x size cave
+	void RunEndless(std::ostream& reportStream, const int& chunks, const int& ticks, const double& speedUp); //endless chunk generation throughput on 1, 2 and 4 workers and a runner going through the rooms at speedUp times the game's pace
+	void RunBroadcast(std::ostream& reportStream, const int& viewers, const int& ticks); //fan-out of the presented frames to local viewers, a few of which never read
+	void RunRenderJitter(std::ostream& reportStream, const int& ticks, const double& nanosecondsPerByte); //tick timing with output on the game thread and on a render thread, with and without a slow terminal
+	void RunIdleMenu(std::ostream& reportStream, const int& seconds); //CPU time of the start screen left alone for seconds
+	void RunInputLatency(std::ostream& reportStream, const int& presses); //key press to the player moving on the terminal through the real game loop, with output on the game thread and on a render thread
+	void RunLiveRooms(std::ostream& reportStream, const int& rooms, const int& ticks, const int& interval); //cost of a tick of a level whose rooms stay live, with more rooms and with more of them having timed tiles, then checks the frames of rooms left and entered again
+	void RunTriggerEffects(std::ostream& reportStream, const int& ticks); //tick cost and effects asked for and done in a room where every touched cell runs triggers
+	void RunTileArchetypes(std::ostream& reportStream, const int& width, const int& height); //memory of the cells of every map of the levels and of a generated width x height room, parse and copy time
+	bool RunBenchmark(std::ostream& reportStream, const int& runs, const bool& record); //plays benchmarks/<level>.script through every level runs times, every frame checked against benchmarks/<level>.golden (written instead with record), false - a run did not match
+	void RunFrameEncoder(std::ostream& reportStream, const int& width, const int& height, const int& frames); //encoding a width x height frame into escape sequences with strings and a stream and with the frame encoder
+};
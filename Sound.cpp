@@ -1,8 +1,15 @@
 #include "Sound.h"
 
 #include <thread>
+std::atomic<bool> Sound::muted(false);
+
 void Sound::Play(const std::string& filename, const HMODULE& hmod, const DWORD& fdwSound)
 {
+	if (muted)
+	{
+		return;
+	}
+
 	//convert std::string to LPCWSTR
 	std::wstring temp(filename.begin(), filename.end());
 	LPCWSTR convertedFilename = temp.c_str();
@@ -1,12 +1,15 @@
 #pragma once
 #include <Windows.h>
 #include <string>
+#include <atomic>
 #include "Exception.h"
 
 enum class SOUND { JUMP = 0, ADD_SCORE_G =  1, ADD_SCORE_B = 2,  DEAL_DMG = 3, SELECT = 4, WIN = 5, LOSE = 6 };
 
 struct Sound
 {
+	static std::atomic<bool> muted; //headless sessions play nothing
+
 	static void Play(const std::string& filename, const HMODULE& hmod = NULL, const DWORD& fdwSound = SND_ASYNC | SND_ALIAS);
 	static void Stop();
 	static std::string GetSoundFilename(SOUND soundName);
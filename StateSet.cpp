@@ -0,0 +1,89 @@
+#include "StateSet.h"
+
+StateSet::StateSet(const int& capacityBits)
+{
+	if (capacityBits < 4 or capacityBits > 40)
+	{
+		throw new Exception(2, "[STATESET] capacity out of range.");
+	}
+
+	unsigned long long capacity = 1ull << capacityBits;
+	_keys.reset(new std::atomic<unsigned long long>[capacity]);
+	_scores.reset(new std::atomic<int>[capacity]);
+	_mask = capacity - 1;
+	_size = 0;
+
+	for (unsigned long long i = 0; i < capacity; i++)
+	{
+		_keys[i].store(0, std::memory_order_relaxed);
+		_scores[i].store(INT_MIN, std::memory_order_relaxed);
+	}
+}
+
+unsigned long long StateSet::Hash(unsigned long long key)
+{
+	//splitmix64 finalizer - neighbouring positions end up far apart
+	key ^= key >> 30;
+	key *= 0xbf58476d1ce4e5b9ull;
+	key ^= key >> 27;
+	key *= 0x94d049bb133111ebull;
+	key ^= key >> 31;
+	return key;
+}
+
+bool StateSet::Insert(const unsigned long long& key, long long& slot)
+{
+	unsigned long long stored = key | USED;
+	unsigned long long index = Hash(key) & _mask;
+
+	for (unsigned long long probes = 0; probes <= _mask; probes++)
+	{
+		unsigned long long current = _keys[index].load(std::memory_order_acquire);
+
+		if (current == 0)
+		{
+			if (_keys[index].compare_exchange_strong(current, stored, std::memory_order_acq_rel))
+			{
+				_size++;
+				slot = static_cast<long long>(index);
+				return true;
+			}
+			//another thread took the slot - current now holds its key
+		}
+
+		if (current == stored)
+		{
+			slot = static_cast<long long>(index);
+			return false;
+		}
+
+		index = (index + 1) & _mask;
+	}
+
+	throw new Exception(2, "[STATESET] state set is full.");
+}
+
+bool StateSet::RaiseScore(const long long& slot, const int& score)
+{
+	int best = _scores[slot].load(std::memory_order_relaxed);
+
+	while (score > best)
+	{
+		if (_scores[slot].compare_exchange_weak(best, score, std::memory_order_relaxed))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int StateSet::Score(const long long& slot) const
+{
+	return _scores[slot].load(std::memory_order_relaxed);
+}
+
+long long StateSet::Size() const
+{
+	return _size;
+}
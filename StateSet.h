@@ -0,0 +1,28 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <climits>
+#include "Exception.h"
+
+// lock-free visited-state set for the level solver: open addressing over packed 63-bit state keys
+// every slot also keeps the best score the state was reached with
+
+class StateSet
+{
+private:
+	static const unsigned long long USED = 1ull << 63; //marks a taken slot, so key 0 is a valid state
+
+	std::unique_ptr<std::atomic<unsigned long long>[]> _keys;
+	std::unique_ptr<std::atomic<int>[]> _scores;
+	unsigned long long _mask; //capacity - 1
+	std::atomic<long long> _size;
+
+	static unsigned long long Hash(unsigned long long key);
+
+public:
+	StateSet(const int& capacityBits = 22); //capacity 2^capacityBits states
+	bool Insert(const unsigned long long& key, long long& slot); //returns false if the key was already there, slot is set either way
+	bool RaiseScore(const long long& slot, const int& score); //returns true if score is higher than the slot's best
+	int Score(const long long& slot) const;
+	long long Size() const;
+};
@@ -0,0 +1,292 @@
+#include "ThreadedScreen.h"
+
+ThreadedScreen::ThreadedScreen(Screen* target, BroadcastServer* viewers)
+{
+	_target = target;
+	_viewers = viewers;
+	_width = 0;
+	_height = 0;
+	_cursor = { 0,0 };
+	_styleTexts = { "" };
+	_styleIndices[""] = 0;
+	_styles = std::make_shared<const std::vector<std::string>>(_styleTexts);
+	_onScreen.styles = _styles;
+	_clears = 0;
+	_published = 0;
+	_changed = false;
+	_presented = 0;
+	_presentedBytes = 0;
+	_presentedNanoseconds = 0;
+	_stopping = false;
+	_renderThread = std::thread(&ThreadedScreen::RenderLoop, this);
+}
+
+ThreadedScreen::~ThreadedScreen()
+{
+	Sync();
+
+	{
+		std::lock_guard<std::mutex> lock(_wakeMutex);
+		_stopping = true;
+	}
+	_frameReady.notify_one();
+	_renderThread.join();
+
+	delete _target;
+}
+
+void ThreadedScreen::Resize(const int& width, const int& height)
+{
+	std::vector<char> glyphs(width * height, ' ');
+	std::vector<unsigned short> glyphStyles(width * height, 0);
+
+	for (int y = 0; y < _height and y < height; y++)
+	{
+		for (int x = 0; x < _width and x < width; x++)
+		{
+			glyphs[y * width + x] = _glyphs[y * _width + x];
+			glyphStyles[y * width + x] = _glyphStyles[y * _width + x];
+		}
+	}
+
+	_glyphs.swap(glyphs);
+	_glyphStyles.swap(glyphStyles);
+	_width = width;
+	_height = height;
+}
+
+void ThreadedScreen::Clear()
+{
+	_glyphs.assign(_glyphs.size(), ' ');
+	_glyphStyles.assign(_glyphStyles.size(), 0);
+	_cursor = { 0,0 };
+	_clears++;
+	_changed = true;
+}
+
+void ThreadedScreen::GotoPosition(const Position& position)
+{
+	_cursor = position;
+	_changed = true;
+}
+
+void ThreadedScreen::Write(const std::string& text)
+{
+	_changed = true;
+
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		if (text[i] == '\u001b' and i + 1 < text.size() and text[i + 1] == '[')
+		{
+			size_t end = text.find('m', i);
+			if (end == std::string::npos)
+			{
+				break;
+			}
+
+			ApplySequence(text.substr(i, end - i + 1));
+			i = end;
+		}
+		else if (text[i] == '\n')
+		{
+			_cursor = { 0, _cursor.y + 1 };
+		}
+		else
+		{
+			Put(text[i]);
+		}
+	}
+}
+
+void ThreadedScreen::ApplySequence(const std::string& sequence)
+{
+	//only colors are used: 30-39 and 90-97 set the text color, 40-49 and 100-107 the background, 0 resets both
+	int code = std::atoi(sequence.c_str() + 2);
+
+	if (code == 0)
+	{
+		_foreground = "";
+		_background = "";
+	}
+	else if ((code >= 30 and code <= 39) or (code >= 90 and code <= 97))
+	{
+		_foreground = sequence;
+	}
+	else if ((code >= 40 and code <= 49) or (code >= 100 and code <= 107))
+	{
+		_background = sequence;
+	}
+}
+
+unsigned short ThreadedScreen::Style()
+{
+	std::string style = _background + _foreground;
+	std::unordered_map<std::string, unsigned short>::const_iterator found = _styleIndices.find(style);
+	if (found != _styleIndices.end())
+	{
+		return found->second;
+	}
+
+	unsigned short index = static_cast<unsigned short>(_styleTexts.size());
+	_styleTexts.push_back(style);
+	_styleIndices[style] = index;
+	_styles = std::make_shared<const std::vector<std::string>>(_styleTexts); //frames already published keep the old table
+	return index;
+}
+
+void ThreadedScreen::Put(const char& character)
+{
+	if (_cursor.x < 0 or _cursor.y < 0)
+	{
+		return;
+	}
+
+	if (_cursor.x >= _width or _cursor.y >= _height)
+	{
+		//grows in steps, every change of size clears the terminal once
+		int width = _width;
+		int height = _height;
+		if (_cursor.x >= width)
+		{
+			width = _cursor.x + 1 > 2 * width ? _cursor.x + 1 : 2 * width;
+		}
+		if (_cursor.y >= height)
+		{
+			height = _cursor.y + 1 > 2 * height ? _cursor.y + 1 : 2 * height;
+		}
+
+		Resize(width, height);
+	}
+
+	_glyphs[_cursor.y * _width + _cursor.x] = character;
+	_glyphStyles[_cursor.y * _width + _cursor.x] = Style();
+	_cursor.x++;
+}
+
+void ThreadedScreen::Flush()
+{
+	if (!_changed)
+	{
+		return;
+	}
+
+	_changed = false;
+	FrameSnapshot& frame = _frames.Back();
+	frame.width = _width;
+	frame.height = _height;
+	frame.glyphs.assign(_glyphs.begin(), _glyphs.end()); //reuses the slot's memory
+	frame.glyphStyles.assign(_glyphStyles.begin(), _glyphStyles.end());
+	frame.styles = _styles;
+	frame.clears = _clears;
+	frame.sequence = ++_published;
+	frame.cursor = _cursor;
+
+	_frames.Publish();
+	_frameReady.notify_one();
+}
+
+void ThreadedScreen::Sync()
+{
+	Flush();
+
+	while (_presented < _published)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+void ThreadedScreen::RenderLoop()
+{
+	while (true)
+	{
+		if (_frames.TakeLatest())
+		{
+			Present(_frames.Front());
+			continue;
+		}
+
+		if (_viewers != nullptr and _viewers->KeyframeWanted())
+		{
+			BroadcastKeyframe(); //a viewer joined while the game shows nothing new
+		}
+
+		std::unique_lock<std::mutex> lock(_wakeMutex);
+		if (_stopping)
+		{
+			return;
+		}
+
+		//the game does not lock when it publishes, so a missed notify only costs the timeout
+		_frameReady.wait_for(lock, std::chrono::milliseconds(5), [this]() { return _stopping or _frames.HasFresh(); });
+	}
+}
+
+void ThreadedScreen::Present(const FrameSnapshot& frame)
+{
+	long long bytesBefore = _target->BytesWritten();
+	long long nanosecondsBefore = _target->WriteNanoseconds();
+	bool cleared = frame.clears != _onScreen.clears or frame.width != _onScreen.width or frame.height != _onScreen.height;
+
+	if (cleared)
+	{
+		_target->Clear();
+		_onScreen.width = frame.width;
+		_onScreen.height = frame.height;
+		_onScreen.glyphs.assign(frame.width * frame.height, ' ');
+		_onScreen.glyphStyles.assign(frame.width * frame.height, 0);
+	}
+
+	//viewers get the clear as an escape sequence, the target has cleared itself
+	_encoder.Clear();
+	if (cleared)
+	{
+		_encoder.ClearScreen();
+	}
+
+	size_t changes = _encoder.Size();
+	_encoder.Encode(frame.glyphs.data(), frame.glyphStyles.data(), _onScreen.glyphs.data(), _onScreen.glyphStyles.data(), frame.width, frame.height, *frame.styles);
+	_encoder.MoveCursor(frame.cursor);
+	_target->WriteBytes(_encoder.Data() + changes, _encoder.Size() - changes);
+	_target->Flush();
+
+	if (_viewers != nullptr and _viewers->Viewers() > 0)
+	{
+		_viewers->PublishFrame(std::string(_encoder.Data(), _encoder.Size())); //one buffer shared by every viewer
+	}
+
+	_onScreen.glyphs = frame.glyphs;
+	_onScreen.glyphStyles = frame.glyphStyles;
+	_onScreen.clears = frame.clears;
+	_onScreen.styles = frame.styles;
+	_onScreen.cursor = frame.cursor;
+	_presentedBytes += _target->BytesWritten() - bytesBefore;
+	_presentedNanoseconds += _target->WriteNanoseconds() - nanosecondsBefore;
+	_presented = frame.sequence;
+
+	if (_viewers != nullptr and _viewers->KeyframeWanted())
+	{
+		BroadcastKeyframe();
+	}
+}
+
+void ThreadedScreen::BroadcastKeyframe()
+{
+	std::vector<char> blankGlyphs(_onScreen.glyphs.size(), ' ');
+	std::vector<unsigned short> blankStyles(_onScreen.glyphStyles.size(), 0);
+
+	_encoder.Clear();
+	_encoder.ClearScreen();
+	_encoder.Encode(_onScreen.glyphs.data(), _onScreen.glyphStyles.data(), blankGlyphs.data(), blankStyles.data(), _onScreen.width, _onScreen.height, *_onScreen.styles);
+	_encoder.MoveCursor(_onScreen.cursor);
+	_viewers->PublishKeyframe(std::string(_encoder.Data(), _encoder.Size()));
+}
+
+long long ThreadedScreen::BytesWritten() const
+{
+	return _presentedBytes;
+}
+
+long long ThreadedScreen::WriteNanoseconds() const
+{
+	return _presentedNanoseconds;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include "Screen.h"
+#include "TripleBuffer.h"
+#include "FrameEncoder.h"
+#include "BroadcastServer.h"
+
+// screen whose output never blocks the game: writes only update a grid of cells, Flush publishes a snapshot of it
+// and a render thread presents the newest snapshot on the target screen, drawing only cells that differ from the last one
+// the changes are encoded once into escape sequence bytes, written to the target and sent to the viewers as they are
+
+class ThreadedScreen : public Screen
+{
+private:
+	struct FrameSnapshot
+	{
+		int width = 0;
+		int height = 0;
+		std::vector<char> glyphs; //row by row
+		std::vector<unsigned short> glyphStyles; //index into styles for every glyph, 0 - terminal default
+		std::shared_ptr<const std::vector<std::string>> styles;
+		long long clears = 0; //Clear calls so far, the terminal is cleared when it changes
+		long long sequence = 0;
+		Position cursor = { 0,0 }; //where the cursor rests after the frame
+	};
+
+	Screen* _target = nullptr; //owned, used only by the render thread once it runs
+	BroadcastServer* _viewers = nullptr; //not owned, nullptr - frames are presented only on the target
+
+	//game thread
+	std::vector<char> _glyphs;
+	std::vector<unsigned short> _glyphStyles;
+	int _width;
+	int _height;
+	Position _cursor;
+	std::string _foreground; //current color sequences
+	std::string _background;
+	std::vector<std::string> _styleTexts;
+	std::unordered_map<std::string, unsigned short> _styleIndices;
+	std::shared_ptr<const std::vector<std::string>> _styles; //copy handed to snapshots, replaced when a style is added
+	long long _clears;
+	long long _published;
+	bool _changed; //written to since the last published frame
+
+	//shared
+	TripleBuffer<FrameSnapshot> _frames;
+	std::atomic<long long> _presented; //sequence of the last presented frame
+	std::atomic<long long> _presentedBytes;
+	std::atomic<long long> _presentedNanoseconds;
+	std::atomic<bool> _stopping;
+	std::mutex _wakeMutex;
+	std::condition_variable _frameReady;
+	std::thread _renderThread;
+
+	//render thread
+	FrameSnapshot _onScreen;
+	FrameEncoder _encoder; //bytes of the presented frame, shared by the target and the viewers
+
+	void Resize(const int& width, const int& height);
+	void Put(const char& character);
+	void ApplySequence(const std::string& sequence); //one "ESC[...m" color sequence
+	unsigned short Style();
+	void RenderLoop();
+	void Present(const FrameSnapshot& frame);
+	void BroadcastKeyframe(); //the screen as presented, for viewers that joined or fell behind
+
+public:
+	ThreadedScreen(Screen* target, BroadcastServer* viewers = nullptr); //takes ownership of target, viewers get every presented frame
+	virtual ~ThreadedScreen(); //presents the last frame and stops the render thread
+	void Clear() override;
+	void GotoPosition(const Position& position) override;
+	void Write(const std::string& text) override;
+	void Flush() override; //publishes the frame, never waits for the terminal
+	void Sync() override;
+	long long BytesWritten() const override; //bytes and time of the target, the terminal's real cost
+	long long WriteNanoseconds() const override;
+};
@@ -0,0 +1,37 @@
+#include "TileArchetypes.h"
+
+unsigned int TileArchetypes::Intern(const EntityTile& tile)
+{
+	size_t hash = tile.Hash();
+	std::pair<IdIndex::const_iterator, IdIndex::const_iterator> range = _ids.equal_range(hash);
+
+	for (IdIndex::const_iterator entry = range.first; entry != range.second; ++entry)
+	{
+		if (_tiles[entry->second].SameAs(tile))
+		{
+			return entry->second;
+		}
+	}
+
+	unsigned int id = static_cast<unsigned int>(_tiles.size());
+	_tiles.push_back(tile);
+	_tiles.back().SetPosition({ 0,0 });
+	_ids.insert({ hash, id });
+	return id;
+}
+
+const EntityTile& TileArchetypes::Get(const unsigned int& id) const
+{
+	return _tiles[id];
+}
+
+int TileArchetypes::Size() const
+{
+	return static_cast<int>(_tiles.size());
+}
+
+void TileArchetypes::Clear()
+{
+	_tiles.clear();
+	_ids.clear();
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include "EntityTile.h"
+#include "Exception.h"
+
+// flyweight table of the distinct tiles of a map: a cell stores only the id of a tile that looks and behaves like it,
+// cells that change are switched to another id (copy on write), archetypes are never removed while the map lives
+
+class TileArchetypes
+{
+private:
+	typedef std::unordered_multimap<size_t, unsigned int, std::hash<size_t>, std::equal_to<size_t>, ArenaAllocator<std::pair<const size_t, unsigned int>, MEMORY_TAG::TILES>> IdIndex;
+
+	std::vector<EntityTile, ArenaAllocator<EntityTile, MEMORY_TAG::TILES>> _tiles; //[id], positions are all {0, 0}
+	IdIndex _ids; //EntityTile::Hash - ids with it
+
+public:
+	unsigned int Intern(const EntityTile& tile); //id of the archetype of tile, added if the map has none like it
+	const EntityTile& Get(const unsigned int& id) const; //a reference only until the next Intern
+	int Size() const;
+	void Clear();
+};
@@ -0,0 +1,102 @@
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(const int& now)
+{
+	Reset(now);
+}
+
+void TimerWheel::Reset(const int& now)
+{
+	_entries.clear();
+	_slots.assign(LEVELS * SLOTS, -1);
+	_free = -1;
+	_now = now;
+	_size = 0;
+}
+
+void TimerWheel::Schedule(const int& due, const int& payload)
+{
+	int index = _free;
+	if (index == -1)
+	{
+		index = static_cast<int>(_entries.size());
+		_entries.push_back({});
+	}
+	else
+	{
+		_free = _entries[index].next;
+	}
+
+	_entries[index].due = due > _now ? due : _now + 1;
+	_entries[index].payload = payload;
+	Insert(index);
+	_size++;
+}
+
+void TimerWheel::Insert(const int& index)
+{
+	Entry& entry = _entries[index];
+
+	//the lowest level whose slots still tell the due tick apart from now
+	int level = 0;
+	while (level < LEVELS - 1 and ((entry.due ^ _now) >> (SLOT_BITS * (level + 1))) != 0)
+	{
+		level++;
+	}
+
+	int& first = _slots[level * SLOTS + ((entry.due >> (SLOT_BITS * level)) & (SLOTS - 1))];
+	entry.next = first;
+	first = index;
+}
+
+int TimerWheel::Detach(const int& level, const int& slot)
+{
+	int& first = _slots[level * SLOTS + slot];
+	int index = first;
+	first = -1;
+	return index;
+}
+
+void TimerWheel::Advance(std::vector<int>& expired)
+{
+	_now++;
+
+	//when a level-l slot comes round its timers are due within the next 64^l ticks - they move down, the highest level first
+	int level = 0;
+	while (level < LEVELS - 1 and (_now & ((1 << (SLOT_BITS * (level + 1))) - 1)) == 0)
+	{
+		level++;
+	}
+
+	for (; level > 0; level--)
+	{
+		int index = Detach(level, (_now >> (SLOT_BITS * level)) & (SLOTS - 1));
+		while (index != -1)
+		{
+			int next = _entries[index].next;
+			Insert(index);
+			index = next;
+		}
+	}
+
+	int index = Detach(0, _now & (SLOTS - 1));
+	while (index != -1)
+	{
+		int next = _entries[index].next;
+		expired.push_back(_entries[index].payload);
+		_entries[index].next = _free;
+		_free = index;
+		_size--;
+		index = next;
+	}
+}
+
+int TimerWheel::Now() const
+{
+	return _now;
+}
+
+int TimerWheel::Size() const
+{
+	return _size;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include "Arena.h"
+
+// hierarchical timer wheel counted in ticks: 4 levels of 64 slots, level l holds timers due within 64^(l+1) ticks
+// a timer sits in one slot until its level's slot comes round, then moves down a level, so a tick only touches
+// the timers that expire in it (and now and then one slot moving down), however many are scheduled
+
+class TimerWheel
+{
+private:
+	static const int SLOT_BITS = 6;
+	static const int SLOTS = 1 << SLOT_BITS;
+	static const int LEVELS = 4; //timers further than 64^4 ticks away go round the top level again
+
+	struct Entry
+	{
+		int due;
+		int payload;
+		int next; //next entry in the same slot (or in the free list), -1 - none
+	};
+
+	std::vector<Entry, ArenaAllocator<Entry, MEMORY_TAG::TIMERS>> _entries;
+	std::vector<int, ArenaAllocator<int, MEMORY_TAG::TIMERS>> _slots; //[level * SLOTS + slot] - first entry, -1 - empty
+	int _free; //first unused entry
+	int _now;
+	int _size;
+
+	void Insert(const int& index); //into the slot of its due tick
+	int Detach(const int& level, const int& slot); //empties the slot, returns its first entry
+
+public:
+	TimerWheel(const int& now = 0);
+	void Schedule(const int& due, const int& payload); //due at or before now - the next tick
+	void Advance(std::vector<int>& expired); //one tick, expired gets the payloads due in it
+	void Reset(const int& now); //forgets every timer
+	int Now() const;
+	int Size() const;
+};
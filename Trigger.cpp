@@ -0,0 +1,61 @@
+#include "Trigger.h"
+
+const std::vector<OptionKind> OptionKind::KINDS =
+{
+	{ 's', OPTION::SWITCH_MAP, 3, { //switch map: room, x, y
+		{ TRIGGER_OP::SWITCH_MAP, { { true, 0 }, { true, 1 }, { true, 2 } } } } },
+
+	{ 'd', OPTION::DEAL_DMG, 1, { //damage: hp
+		{ TRIGGER_OP::PLAY_SOUND, { { false, static_cast<int>(SOUND::DEAL_DMG) } } },
+		{ TRIGGER_OP::LOSE_HP, { { true, 0 } } } } },
+
+	{ 'g', OPTION::ADD_SCORE, 4, { //score (gold): score, collected character, tile color, background color
+		{ TRIGGER_OP::PLAY_SCORE_SOUND, { { true, 0 } } },
+		{ TRIGGER_OP::ADD_SCORE, { { true, 0 } } },
+		{ TRIGGER_OP::COLLECT, { { true, 1 }, { true, 2 }, { true, 3 } } } } },
+
+	{ 'e', OPTION::EXIT_LEVEL, 0, { //exit level
+		{ TRIGGER_OP::END_LEVEL, {} } } },
+
+	{ 'c', OPTION::COLLIDABLE, 0, {} }, //collidable
+
+	{ 't', OPTION::TIMED, 3, {} }, //timed: option, period, character, offset
+};
+
+const OptionKind* OptionKind::Find(const char& letter)
+{
+	for (const OptionKind& kind : KINDS)
+	{
+		if (kind.letter == letter)
+		{
+			return &kind;
+		}
+	}
+
+	return nullptr;
+}
+
+void OptionKind::Compile(const Option& option, std::vector<TriggerOp, ArenaAllocator<TriggerOp, MEMORY_TAG::TRIGGERS>>& ops)
+{
+	for (const OptionKind& kind : KINDS)
+	{
+		if (kind.option != option.optionName)
+		{
+			continue;
+		}
+
+		for (const Effect& effect : kind.effects)
+		{
+			TriggerOp op = { effect.op, { 0, 0, 0 } };
+			for (int i = 0; i < 3; i++)
+			{
+				const Operand& operand = effect.operands[i];
+				op.operands[i] = operand.argument ? option.arguments[operand.value] : operand.value;
+			}
+
+			ops.push_back(op);
+		}
+
+		return;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include "Option.h"
+#include "Sound.h"
+
+// what touching a tile does: every option of a .map tile is compiled into a short list of ops when the map is loaded,
+// the game only looks up the ops of the cells the player touches and runs them
+// a new trigger is a row of OptionKind::KINDS (and an op, if it needs one the game cannot do yet)
+
+enum class TRIGGER_OP { PLAY_SOUND = 0, PLAY_SCORE_SOUND = 1, LOSE_HP = 2, ADD_SCORE = 3, COLLECT = 4, SWITCH_MAP = 5, END_LEVEL = 6 };
+
+struct TriggerOp
+{
+	TRIGGER_OP op;
+	int operands[3];
+};
+
+struct Trigger //one option of one tile
+{
+	OPTION option;
+	bool enabled; //the tile has the option now - collected pickups and timed tiles switch it off
+	int firstOp; //into the map's op list
+	int opsNumber;
+};
+
+struct OptionKind //how an option is written in a .map file and what touching it does
+{
+	struct Operand
+	{
+		bool argument; //true - value is an index into the option's arguments, false - value itself
+		int value;
+	};
+
+	struct Effect //op with operands still to be taken from the option
+	{
+		TRIGGER_OP op;
+		Operand operands[3];
+	};
+
+	char letter;
+	OPTION option;
+	size_t requiredArguments;
+	std::vector<Effect> effects; //run in order, none - the option is not a trigger
+
+	static const std::vector<OptionKind> KINDS; //triggers of one tile run in this order
+	static const OptionKind* Find(const char& letter); //nullptr - not an option (colors are parsed by Map)
+	static void Compile(const Option& option, std::vector<TriggerOp, ArenaAllocator<TriggerOp, MEMORY_TAG::TRIGGERS>>& ops); //appends the effects of option's kind with its arguments
+};
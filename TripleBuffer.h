@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+
+// lock-free single producer / single consumer exchange of whole values:
+// the producer fills Back and publishes it, the consumer takes the newest published value and skips older ones
+
+template<class T> class TripleBuffer
+{
+private:
+	static const int FRESH = 4; //flag next to the slot index in _middle: published and not taken yet
+
+	T _slots[3];
+	int _back; //owned by the producer
+	int _front; //owned by the consumer
+	std::atomic<int> _middle;
+
+public:
+	TripleBuffer()
+	{
+		_back = 0;
+		_middle = 1;
+		_front = 2;
+	}
+
+	T& Back()
+	{
+		return _slots[_back];
+	}
+
+	void Publish()
+	{
+		_back = _middle.exchange(_back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+	}
+
+	bool HasFresh() const
+	{
+		return (_middle.load(std::memory_order_acquire) & FRESH) != 0;
+	}
+
+	bool TakeLatest() //false if nothing was published since the last take
+	{
+		if (!HasFresh())
+		{
+			return false;
+		}
+
+		_front = _middle.exchange(_front, std::memory_order_acq_rel) & ~FRESH;
+		return true;
+	}
+
+	const T& Front() const
+	{
+		return _slots[_front];
+	}
+};
@@ -0,0 +1,166 @@
+#include "WorkStealingPool.h"
+
+static thread_local WorkStealingPool* currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+WorkStealingPool::WorkStealingPool(const int& threads)
+{
+	int threadsNumber = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+	if (threadsNumber <= 0)
+	{
+		threadsNumber = 1;
+	}
+
+	_unfinishedTasks = 0;
+	_pendingTasks = 0;
+	_nextWorker = 0;
+	_steals = 0;
+	_stopping = false;
+
+	for (int i = 0; i < threadsNumber; i++)
+	{
+		_workers.push_back(std::unique_ptr<Worker>(new Worker()));
+	}
+
+	for (int i = 0; i < threadsNumber; i++)
+	{
+		_threads.push_back(std::thread(&WorkStealingPool::WorkerLoop, this, i));
+	}
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		//an error nobody waited for goes away with the pool
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_allFinished.wait(lock, [this]() { return _unfinishedTasks == 0; });
+		_stopping = true;
+	}
+	_taskSubmitted.notify_all();
+
+	for (std::thread& thread : _threads)
+	{
+		thread.join();
+	}
+}
+
+void WorkStealingPool::WorkerLoop(const int& workerIndex)
+{
+	currentPool = this;
+	currentWorker = workerIndex;
+
+	while (true)
+	{
+		std::function<void()> task;
+
+		if (TakeTask(workerIndex, task))
+		{
+			{
+				std::lock_guard<std::mutex> lock(_sleepMutex);
+				_pendingTasks--;
+			}
+
+			//a throw would end the process and leave Wait blocked forever, the first one is thrown again by Wait
+			try
+			{
+				task();
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(_sleepMutex);
+				if (!_error)
+				{
+					_error = std::current_exception();
+				}
+			}
+
+			if (--_unfinishedTasks == 0)
+			{
+				std::lock_guard<std::mutex> lock(_sleepMutex);
+				_allFinished.notify_all();
+			}
+
+			continue;
+		}
+
+		//sleeps until a task is in a deque - Submit counts it under the same mutex, so no wakeup is lost
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_taskSubmitted.wait(lock, [this]() { return _stopping or _pendingTasks > 0; });
+		if (_stopping)
+		{
+			return;
+		}
+	}
+}
+
+bool WorkStealingPool::TakeTask(const int& workerIndex, std::function<void()>& task)
+{
+	{
+		Worker& worker = *_workers[workerIndex];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+
+		if (!worker.tasks.empty())
+		{
+			task = std::move(worker.tasks.back());
+			worker.tasks.pop_back();
+			return true;
+		}
+	}
+
+	int workersNumber = static_cast<int>(_workers.size());
+	for (int i = 1; i < workersNumber; i++)
+	{
+		Worker& victim = *_workers[(workerIndex + i) % workersNumber];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+
+		if (!victim.tasks.empty())
+		{
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			_steals++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WorkStealingPool::Submit(const std::function<void()>& task)
+{
+	_unfinishedTasks++;
+
+	int workerIndex = (currentPool == this) ? currentWorker : (_nextWorker++ % static_cast<int>(_workers.size()));
+
+	{
+		Worker& worker = *_workers[workerIndex];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.tasks.push_back(task);
+	}
+
+	std::lock_guard<std::mutex> lock(_sleepMutex);
+	_pendingTasks++;
+	_taskSubmitted.notify_one();
+}
+
+void WorkStealingPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(_sleepMutex);
+	_allFinished.wait(lock, [this]() { return _unfinishedTasks == 0; });
+
+	if (_error)
+	{
+		std::exception_ptr error = _error;
+		_error = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+int WorkStealingPool::Threads() const
+{
+	return static_cast<int>(_threads.size());
+}
+
+long long WorkStealingPool::Steals() const
+{
+	return _steals;
+}
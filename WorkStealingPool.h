@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+
+// fixed set of worker threads, each with its own task deque
+// a worker takes its newest task first and steals the oldest task of another worker when it runs out
+
+class WorkStealingPool
+{
+private:
+	struct Worker
+	{
+		std::deque<std::function<void()>> tasks;
+		std::mutex mutex;
+	};
+
+	std::vector<std::unique_ptr<Worker>> _workers;
+	std::vector<std::thread> _threads;
+	std::atomic<int> _unfinishedTasks;
+	std::atomic<int> _nextWorker; //round robin for tasks submitted from outside the pool
+	std::atomic<long long> _steals;
+	std::atomic<bool> _stopping;
+	int _pendingTasks; //in the deques, not taken yet - under _sleepMutex, below 0 while a task is taken before its Submit counted it
+	std::mutex _sleepMutex;
+	std::condition_variable _taskSubmitted;
+	std::condition_variable _allFinished;
+	std::exception_ptr _error; //first exception a task threw since the last Wait, under _sleepMutex
+
+	void WorkerLoop(const int& workerIndex);
+	bool TakeTask(const int& workerIndex, std::function<void()>& task); //own newest task or a stolen oldest one
+
+public:
+	WorkStealingPool(const int& threads = 0); //0 - one thread per hardware thread
+	~WorkStealingPool(); //waits for all tasks
+	void Submit(const std::function<void()>& task); //from inside a task it goes to the current worker's deque
+	void Wait(); //blocks until every submitted task (and every task they submitted) has finished, then throws what the first failed task threw
+	int Threads() const;
+	long long Steals() const;
+};
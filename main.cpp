@@ -1,10 +1,192 @@
 #include "Game.h"
+#include "Simulation.h"
+#include "LevelSolver.h"
 
-int main()
+int main(int argc, char* argv[])
 {
+	std::vector<std::string> levels = { "levels/level2.level", "levels/level1.level" };
+
 	try
 	{
-		Game game = Game({ "levels/level2.level", "levels/level1.level" });
+		// --simulate <sessions> <ticks per session> [threads] [input script]
+		if (argc >= 4 and std::string(argv[1]) == "--simulate")
+		{
+			Simulation simulation(levels, std::stoi(argv[2]), std::stoi(argv[3]), argc >= 5 ? std::stoi(argv[4]) : 0, argc >= 6 ? argv[5] : "");
+			simulation.Run(std::cout);
+			return 0;
+		}
+
+		// --restarts <count>
+		if (argc >= 3 and std::string(argv[1]) == "--restarts")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunRestarts(std::cout, std::stoi(argv[2]));
+			return 0;
+		}
+
+		// --rewind [seconds] [ticks per second]
+		if (argc >= 2 and std::string(argv[1]) == "--rewind")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunRewind(std::cout, argc >= 3 ? std::stoi(argv[2]) : 60, argc >= 4 ? std::stoi(argv[3]) : 60);
+			return 0;
+		}
+
+		// --render-jitter <ticks> [slow terminal nanoseconds per byte]
+		if (argc >= 3 and std::string(argv[1]) == "--render-jitter")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunRenderJitter(std::cout, std::stoi(argv[2]), argc >= 4 ? std::stod(argv[3]) : 20000.0);
+			return 0;
+		}
+
+		// --idle [seconds]
+		if (argc >= 2 and std::string(argv[1]) == "--idle")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunIdleMenu(std::cout, argc >= 3 ? std::stoi(argv[2]) : 60);
+			return 0;
+		}
+
+		// --latency [presses]
+		if (argc >= 2 and std::string(argv[1]) == "--latency")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunInputLatency(std::cout, argc >= 3 ? std::stoi(argv[2]) : 100);
+			return 0;
+		}
+
+		// --encode [width] [height] [frames]
+		if (argc >= 2 and std::string(argv[1]) == "--encode")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunFrameEncoder(std::cout, argc >= 3 ? std::stoi(argv[2]) : 300, argc >= 4 ? std::stoi(argv[3]) : 100, argc >= 5 ? std::stoi(argv[4]) : 1000);
+			return 0;
+		}
+
+		// --benchmark [runs], --benchmark-record
+		if (argc >= 2 and (std::string(argv[1]) == "--benchmark" or std::string(argv[1]) == "--benchmark-record"))
+		{
+			bool record = std::string(argv[1]) == "--benchmark-record";
+			Simulation simulation(levels, 0, 0);
+			return simulation.RunBenchmark(std::cout, !record and argc >= 3 ? std::stoi(argv[2]) : 1, record) ? 0 : 1;
+		}
+
+		// --rooms [rooms] [ticks] [ticks between batches]
+		if (argc >= 2 and std::string(argv[1]) == "--rooms")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunLiveRooms(std::cout, argc >= 3 ? std::stoi(argv[2]) : 1000, argc >= 4 ? std::stoi(argv[3]) : 3000, argc >= 5 ? std::stoi(argv[4]) : 8);
+			return 0;
+		}
+
+		// --live-rooms [ticks between batches]
+		if (argc >= 2 and std::string(argv[1]) == "--live-rooms")
+		{
+			Game game(levels);
+			game.SetLiveRooms(argc >= 3 ? std::stoi(argv[2]) : 8);
+			game.Start();
+			return 0;
+		}
+
+		// --effects [ticks]
+		if (argc >= 2 and std::string(argv[1]) == "--effects")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunTriggerEffects(std::cout, argc >= 3 ? std::stoi(argv[2]) : 3000);
+			return 0;
+		}
+
+		// --tiles [generated width] [generated height]
+		if (argc >= 2 and std::string(argv[1]) == "--tiles")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunTileArchetypes(std::cout, argc >= 3 ? std::stoi(argv[2]) : 1000, argc >= 4 ? std::stoi(argv[3]) : 200);
+			return 0;
+		}
+
+		// --timers <timed tiles> <ticks>
+		if (argc >= 4 and std::string(argv[1]) == "--timers")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunTimers(std::cout, std::stoi(argv[2]), std::stoi(argv[3]));
+			return 0;
+		}
+
+		// --fov <map size> <view radius> <ticks>
+		if (argc >= 5 and std::string(argv[1]) == "--fov")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunFieldOfView(std::cout, std::stoi(argv[2]), std::stoi(argv[3]), std::stoi(argv[4]));
+			return 0;
+		}
+
+		// --flow <map size> <followers> <ticks>
+		if (argc >= 5 and std::string(argv[1]) == "--flow")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunFlowField(std::cout, std::stoi(argv[2]), std::stoi(argv[3]), std::stoi(argv[4]));
+			return 0;
+		}
+
+		// --endless
+		if (argc >= 2 and std::string(argv[1]) == "--endless")
+		{
+			Game game({ "levels/endless.level" });
+			game.Start();
+			return 0;
+		}
+
+		// --endless-load <chunks> <ticks> [speed-up over 30 Hz, 0 - unpaced]
+		if (argc >= 4 and std::string(argv[1]) == "--endless-load")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunEndless(std::cout, std::stoi(argv[2]), std::stoi(argv[3]), argc >= 5 ? std::stod(argv[4]) : 10.0);
+			return 0;
+		}
+
+		// --solve [threads] [level files...]
+		if (argc >= 2 and std::string(argv[1]) == "--solve")
+		{
+			int firstLevel = 2;
+			int threads = 0;
+			if (argc >= 3 and std::string(argv[2]).find_first_not_of("0123456789") == std::string::npos)
+			{
+				threads = std::stoi(argv[2]);
+				firstLevel = 3;
+			}
+
+			LevelSolver solver(threads);
+			solver.Run(argc > firstLevel ? std::vector<std::string>(argv + firstLevel, argv + argc) : levels, std::cout);
+			return 0;
+		}
+
+		// --memory
+		if (argc >= 2 and std::string(argv[1]) == "--memory")
+		{
+			Game game(levels);
+			game.SetMemoryOverlay(true);
+			game.Start();
+			return 0;
+		}
+
+		// --broadcast <port> [bind address, 0.0.0.0 - watchable from other machines]
+		if (argc >= 3 and std::string(argv[1]) == "--broadcast")
+		{
+			Game game(levels, 30, 1, std::stoi(argv[2]), argc >= 4 ? argv[3] : "127.0.0.1");
+			game.Start();
+			return 0;
+		}
+
+		// --broadcast-load <viewers> <ticks>
+		if (argc >= 4 and std::string(argv[1]) == "--broadcast-load")
+		{
+			Simulation simulation(levels, 0, 0);
+			simulation.RunBroadcast(std::cout, std::stoi(argv[2]), std::stoi(argv[3]));
+			return 0;
+		}
+
+		Game game(levels);
 		game.Start();
 	}
 	catch (Exception* exception)
@@ -18,4 +200,4 @@ int main()
 	}
 
 	return 0;
-}
\ No newline at end of file
+}